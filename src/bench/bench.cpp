@@ -0,0 +1,685 @@
+// flow_imbalance_bench -- microbenchmarks for the tick path plus a loopback end-to-end run
+// Usage: flow_imbalance_bench [--filter=<substr>] [--json] [--quick] [--e2e-ticks=<n>]
+//   --filter=<s>     only run benchmarks whose name contains <s> (e.g. parse, e2e)
+//   --json           one JSON object per line instead of key=value lines
+//   --quick          shorter timing windows, smaller e2e run (smoke test)
+//   --e2e-ticks=<n>  ticks sent per end-to-end run (default 1000000)
+//
+// Output: one `BENCH name=... ` line per benchmark, stable keys, so runs from two
+// builds can be diffed or collected by a script. Microbenchmarks report the median
+// ns/op of 5 timed repetitions; e2e runs report ticks/s and the src_ts -> decision
+// latency distribution through UdpIngest + Engine on 127.0.0.1.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "main/Engine.h"
+#include "main/OFI.h"
+#include "main/OrderBook.h"
+#include "main/SymbolStore.h"
+#include "main/features/FeatureEngine.h"
+#include "main/ingest/UdpIngest.h"
+#include "main/metrics/SharedMetrics.h"
+#include "main/parser/BinaryTick.h"
+#include "main/parser/TickParser.h"
+#include "main/predictor/Predictor.h"
+#include "main/predictor/PredictorBank.h"
+#include "main/predictor/StaticPredictor.h"
+#include "main/stats/LatencyHistogram.h"
+#include "main/stats/TscClock.h"
+#include "main/store/TickStore.h"
+
+namespace {
+
+using steady_clock = std::chrono::steady_clock;
+
+// keep a value alive so the optimiser cannot drop the work that produced it
+template <typename T>
+inline void keep(const T& v) {
+    asm volatile("" : : "r,m"(v) : "memory");
+}
+
+double wall_now() {
+    return std::chrono::duration_cast<std::chrono::duration<double>>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+struct Options {
+    std::string filter;
+    bool json = false;
+    bool quick = false;
+    size_t e2e_ticks = 1000000;
+};
+
+Options opt;
+
+bool selected(const std::string& name) {
+    return opt.filter.empty() || name.find(opt.filter) != std::string::npos;
+}
+
+// counts print exactly, measurements with 6 significant digits
+void format_number(char* buf, size_t cap, double v) {
+    if (v == std::floor(v) && std::fabs(v) < 1e15) std::snprintf(buf, cap, "%.0f", v);
+    else std::snprintf(buf, cap, "%.6g", v);
+}
+
+// one output line: name plus ordered numeric fields
+void emit(const std::string& name, const std::vector<std::pair<const char*, double>>& fields) {
+    std::string line;
+    char num[64];
+    if (opt.json) {
+        line = "{\"name\":\"" + name + "\"";
+        for (const auto& f : fields) {
+            format_number(num, sizeof(num), f.second);
+            line += std::string(",\"") + f.first + "\":" + num;
+        }
+        line += "}\n";
+    } else {
+        line = "BENCH name=" + name;
+        for (const auto& f : fields) {
+            format_number(num, sizeof(num), f.second);
+            line += std::string(" ") + f.first + "=" + num;
+        }
+        line += "\n";
+    }
+    std::fwrite(line.data(), 1, line.size(), stdout);
+    std::fflush(stdout);
+}
+
+// time fn() (which performs `ops` operations per call): grow the call count until one
+// repetition takes ~1/5 of the window, then report the median of 5 repetitions
+template <typename F>
+void bench(const std::string& name, size_t ops, F&& fn) {
+    if (!selected(name)) return;
+    const double window_s = opt.quick ? 0.05 : 0.5;
+    auto time_calls = [&](uint64_t calls) {
+        auto t0 = steady_clock::now();
+        for (uint64_t c = 0; c < calls; ++c) fn();
+        return std::chrono::duration<double>(steady_clock::now() - t0).count();
+    };
+    uint64_t calls = 1;
+    while (time_calls(calls) < window_s / 5 && calls < (uint64_t(1) << 40)) calls *= 2;
+    double reps[5];
+    for (double& r : reps) r = time_calls(calls) * 1e9 / double(calls * ops);
+    std::sort(reps, reps + 5);
+    emit(name, {{"ops", double(calls * ops * 5)},
+                {"ns_per_op", reps[2]},
+                {"ops_per_s", 1e9 / reps[2]},
+                {"min_ns_per_op", reps[0]},
+                {"max_ns_per_op", reps[4]}});
+}
+
+// deterministic price walk of trade ticks over `symbols` instruments
+std::vector<Tick> make_trades(size_t n, uint32_t symbols, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<double> step(0.0, 0.05);
+    std::uniform_int_distribution<uint32_t> size(1, 1000);
+    std::vector<double> px(symbols, 100.0);
+    std::vector<Tick> out(n);
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t s = uint32_t(i % symbols);
+        double d = step(rng);
+        px[s] += d;
+        out[i] = Tick{i, 1.7e9 + double(i) * 1e-6, 0.0, px[s], size(rng), s, int8_t(d > 0 ? 1 : -1), TickType::Trade};
+    }
+    return out;
+}
+
+// L2 updates shaped like feedgen.py --book: 5 levels a side around a one-tick spread,
+// mostly size modifications near the touch, occasionally the touch moves
+std::vector<Tick> make_quotes(size_t n, uint32_t symbols, uint64_t seed) {
+    constexpr double TICK = 0.01;
+    constexpr int LEVELS = 5;
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    std::uniform_int_distribution<uint32_t> size(1, 1000);
+    std::exponential_distribution<double> depth(1.0);
+    std::vector<int64_t> bid(symbols, 10000);
+    std::vector<Tick> out;
+    out.reserve(n + 4 * LEVELS);
+    uint64_t seq = 0;
+    auto push = [&](uint32_t s, int64_t idx, uint32_t sz, int side, TickType t) {
+        out.push_back(Tick{seq, 1.7e9 + double(seq) * 1e-6, 0.0, double(idx) * TICK, sz, s, int8_t(side), t});
+        ++seq;
+    };
+    for (uint32_t s = 0; s < symbols; ++s) {
+        for (int i = 0; i < LEVELS; ++i) {
+            push(s, bid[s] - i, size(rng), 1, TickType::Add);
+            push(s, bid[s] + 1 + i, size(rng), -1, TickType::Add);
+        }
+    }
+    while (out.size() < n) {
+        uint32_t s = uint32_t(seq % symbols);
+        int64_t b = bid[s], a = b + 1;
+        double r = u(rng);
+        if (r < 0.05) {
+            push(s, a, 0, -1, TickType::Delete);
+            push(s, a, size(rng), 1, TickType::Add);
+            push(s, a + LEVELS, size(rng), -1, TickType::Add);
+            push(s, b - LEVELS + 1, 0, 1, TickType::Delete);
+            bid[s] = a;
+        } else if (r < 0.10) {
+            push(s, b, 0, 1, TickType::Delete);
+            push(s, b, size(rng), -1, TickType::Add);
+            push(s, b - LEVELS, size(rng), 1, TickType::Add);
+            push(s, a + LEVELS - 1, 0, -1, TickType::Delete);
+            bid[s] = b - 1;
+        } else {
+            int side = u(rng) < 0.5 ? 1 : -1;
+            int64_t lvl = std::min<int64_t>(int64_t(depth(rng)), LEVELS - 1);
+            push(s, side == 1 ? b - lvl : a + lvl, size(rng), side, TickType::Modify);
+        }
+    }
+    out.resize(n);
+    return out;
+}
+
+std::vector<std::string> make_csv_lines(const std::vector<Tick>& ticks, bool with_symbol) {
+    std::vector<std::string> lines;
+    lines.reserve(ticks.size());
+    char buf[128];
+    for (const Tick& t : ticks) {
+        int n = with_symbol
+                    ? std::snprintf(buf, sizeof(buf), "%llu,%.9f,%.6f,%u,SYM%u\n", (unsigned long long)t.seq,
+                                    t.src_ts, t.price, t.size, t.symbol)
+                    : std::snprintf(buf, sizeof(buf), "%llu,%.9f,%.6f,%u\n", (unsigned long long)t.seq, t.src_ts,
+                                    t.price, t.size);
+        lines.emplace_back(buf, size_t(n));
+    }
+    return lines;
+}
+
+// one read of each interval clock the tick path could use
+void bench_clock() {
+    bench("clock/steady_clock_now", 1024, [&] {
+        int64_t x = 0;
+        for (int i = 0; i < 1024; ++i) x += steady_clock::now().time_since_epoch().count();
+        keep(x);
+    });
+    bench("clock/clock_gettime_monotonic", 1024, [&] {
+        uint64_t x = 0;
+        for (int i = 0; i < 1024; ++i) x += TscClock::monotonic_ns();
+        keep(x);
+    });
+    if (!TscClock::tsc()) return;
+    bench("clock/tsc_now", 1024, [&] {
+        uint64_t x = 0;
+        for (int i = 0; i < 1024; ++i) x += TscClock::now();
+        keep(x);
+    });
+}
+
+void bench_parsing() {
+    const auto trades = make_trades(4096, 16, 1);
+    for (bool sym : {false, true}) {
+        const auto lines = make_csv_lines(trades, sym);
+        bench(sym ? "parse/csv_symbol" : "parse/csv", lines.size(), [&] {
+            Tick t{};
+            std::string_view name;
+            for (const auto& l : lines) {
+                parse_tick_csv(l.data(), l.size(), t, name);
+                keep(t);
+            }
+        });
+    }
+
+    constexpr size_t PER_DGRAM = 32;
+    std::vector<char> dgram(sizeof(BinaryTickHeader) + PER_DGRAM * sizeof(BinaryTickV2));
+    encode_binary_ticks(trades.data(), PER_DGRAM, dgram.data(), dgram.size());
+    bench("parse/binary_x32", PER_DGRAM, [&] {
+        int cnt = binary_tick_count(dgram.data(), dgram.size());
+        Tick t;
+        for (int r = 0; r < cnt; ++r) {
+            decode_binary_tick(dgram.data(), r, t);
+            keep(t);
+        }
+    });
+
+    // decode including format detection and symbol interning
+    EngineConfig cfg;
+    Engine engine(cfg);
+    const auto lines = make_csv_lines(trades, true);
+    bench("engine/decode_csv_symbol", lines.size(), [&] {
+        for (const auto& l : lines) engine.decode(l.data(), l.size(), 0.0, [](const Tick& t) { keep(t); });
+    });
+}
+
+void bench_ofi() {
+    const auto trades = make_trades(4097, 1, 2);
+    bench("ofi/trade_proxy", trades.size() - 1, [&] {
+        double s = 0.0;
+        for (size_t i = 1; i < trades.size(); ++i) s += compute_ofi(trades[i - 1], trades[i]);
+        keep(s);
+    });
+
+    // book states sampled from the quote stream
+    const auto quotes = make_quotes(4096 + 16, 1, 3);
+    constexpr size_t LV = 5;
+    OrderBook book(0.01, 1024);
+    std::vector<BookTop> tops;
+    std::vector<BookLevel> bids, asks;
+    BookLevel lv[LV];
+    for (size_t i = 0; i < quotes.size(); ++i) {
+        book.apply_tick(quotes[i]);
+        if (i < 16) continue;
+        tops.push_back(book.top());
+        book.depth(1, LV, lv);
+        bids.insert(bids.end(), lv, lv + LV);
+        book.depth(-1, LV, lv);
+        asks.insert(asks.end(), lv, lv + LV);
+    }
+    bench("ofi/top_of_book", tops.size() - 1, [&] {
+        double s = 0.0;
+        for (size_t i = 1; i < tops.size(); ++i) s += compute_ofi(tops[i - 1], tops[i]);
+        keep(s);
+    });
+    bench("ofi/mlofi_5", tops.size() - 1, [&] {
+        double s = 0.0;
+        for (size_t i = 1; i < tops.size(); ++i) {
+            s += compute_mlofi(&bids[(i - 1) * LV], &asks[(i - 1) * LV], &bids[i * LV], &asks[i * LV], LV);
+        }
+        keep(s);
+    });
+}
+
+void bench_book() {
+    const auto quotes = make_quotes(1 << 16, 1, 4);
+    OrderBook book(0.01, 1024);
+    bench("book/apply_tick", quotes.size(), [&] {
+        for (const Tick& t : quotes) book.apply_tick(t);
+        keep(book);
+    });
+
+    // per-symbol path as Engine::process runs it: book update + OFI
+    constexpr uint32_t NSYM = 64;
+    const auto multi = make_quotes(1 << 16, NSYM, 5);
+    for (size_t levels : {size_t(1), size_t(5)}) {
+        SymbolStore store(NSYM, 0.15, 40.0, 0.01, 1024, levels);
+        bench("store/apply_tick_ofi" + std::to_string(levels) + "_sym" + std::to_string(NSYM), multi.size(), [&] {
+            double s = 0.0, ofi;
+            for (const Tick& t : multi) s += store.apply_tick(t.symbol, t, ofi) ? ofi : 0.0;
+            keep(s);
+        });
+    }
+}
+
+// what Engine::process adds per tick with --metrics: three counters and the last-tick seqlock
+// (process memory here; the shared mapping costs the same stores)
+void bench_metrics() {
+    std::unique_ptr<MetricsSlot> slot(new MetricsSlot());
+    const auto quotes = make_quotes(4096, 64, 7);
+    bench("metrics/publish_tick", quotes.size(), [&] {
+        MetricsSlot& m = *slot;
+        for (const Tick& t : quotes) {
+            metric_add(m.ticks);
+            metric_add(t.size > 100 ? m.buy : m.sell);
+            m.last_tick.write(MetricsTick{t.seq, t.symbol, 1, t.price, double(t.size), t.src_ts, t.recv_ts, 3, 16});
+        }
+    });
+    LatencyHistogram h;
+    std::mt19937_64 rng(8);
+    std::lognormal_distribution<double> ld(8.0, 1.0);
+    for (int i = 0; i < 100000; ++i) h.record(uint64_t(ld(rng)));
+    bench("metrics/publish_latency", 1, [&] {
+        static constexpr double Q[] = {0.5, 0.9, 0.99, 0.999};
+        uint64_t v[4];
+        h.percentiles(Q, v, 4);
+        slot->latency.write(MetricsLatency{{h.count(), v[0], v[1], v[2], v[3], h.max()}, {}, 0.0});
+    });
+}
+
+// the --store writer thread's cost per row: nine column appends into the mapped segment,
+// growth and segment rolls included (the hot thread only pays a 64-byte ring push).
+// Closed segments are deleted as the run goes so the benchmark does not fill the disk
+void bench_store() {
+    if (!selected("store/append_row")) return;
+    char tmpl[] = "/tmp/flow_imbalance_bench_store.XXXXXX";
+    if (!mkdtemp(tmpl)) {
+        std::perror("mkdtemp");
+        return;
+    }
+    const std::string dir(tmpl);
+    SymbolTable symbols(64);
+    {
+        TickStore store(TickStoreConfig{dir, size_t(4) << 20, 2}, symbols);
+        std::string err;
+        if (!store.open(err)) {
+            std::fprintf(stderr, "store: %s\n", err.c_str());
+            return;
+        }
+        const auto quotes = make_quotes(4096, 64, 9);
+        uint32_t removed = 0;
+        double ewma = 0.0;
+        bench("store/append_row", quotes.size(), [&] {
+            for (const Tick& t : quotes) {
+                ewma = 0.85 * ewma + 0.15 * double(t.size);
+                store.append(StoreTick{t.seq, t.src_ts, t.recv_ts, t.price, double(t.size), ewma, t.size, t.symbol,
+                                       int8_t(int(t.seq % 3) - 1), int32_t(t.seq % 17) - 8});
+            }
+            // the newest segment may still be open
+            for (; removed + 1 < store.segments(); ++removed) std::filesystem::remove_all(segment_dir(dir, removed));
+        });
+    }
+    std::filesystem::remove_all(dir);
+}
+
+// a compile-time predictor on integral OFI (what compute_ofi produces): ns/op, then its
+// decisions and EWMA against the runtime double predictor over a long stream
+template <typename Rep>
+void bench_static_predictor(const std::string& name, const std::vector<double>& ofi) {
+    using P = StaticPredictor<Rep, ENGINE_ALPHA, ENGINE_THRESHOLD>;
+    P p;
+    bench(name, ofi.size(), [&] {
+        int a = 0;
+        for (double x : ofi) a += p.process_sample(x);
+        keep(a);
+    });
+    const std::string agree = name + "/agreement";
+    if (!selected(agree)) return;
+    std::mt19937_64 rng(17);
+    std::normal_distribution<double> nd(0.0, 300.0);
+    const size_t n = opt.quick ? 100000 : 10000000;
+    double ref = 0.0;
+    typename P::state_type st{};
+    uint64_t mismatches = 0;
+    double max_err = 0.0, max_rel_err = 0.0, worst_margin = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        double x = std::round(nd(rng));
+        int want = Predictor::step(ref, ENGINE_ALPHA, ENGINE_THRESHOLD, x);
+        int got = P::step(st, x);
+        double err = std::fabs(P::to_double(st) - ref);
+        max_err = std::max(max_err, err);
+        if (std::fabs(ref) > 1.0) max_rel_err = std::max(max_rel_err, err / std::fabs(ref));
+        if (got != want) {
+            ++mismatches;
+            // distance of the reference EWMA from the threshold it was compared against
+            worst_margin = std::max(worst_margin, std::fabs(std::fabs(ref) - ENGINE_THRESHOLD));
+        }
+    }
+    emit(agree, {{"samples", double(n)},
+                 {"decision_mismatches", double(mismatches)},
+                 {"mismatch_rate", double(mismatches) / double(n)},
+                 {"max_ewma_err", max_err},
+                 {"max_rel_ewma_err", max_rel_err},
+                 {"mismatch_max_margin", worst_margin}});
+}
+
+void bench_predictor() {
+    std::mt19937_64 rng(6);
+    std::normal_distribution<double> nd(0.0, 300.0);
+    std::vector<double> ofi(4096);
+    for (double& x : ofi) x = nd(rng);
+
+    Predictor pred(0.15, 40.0);
+    bench("predictor/process_sample", ofi.size(), [&] {
+        int a = 0;
+        for (double x : ofi) a += pred.process_sample(x);
+        keep(a);
+    });
+    bench("predictor/process_sample_unlocked", ofi.size(), [&] {
+        int a = 0;
+        for (double x : ofi) a += pred.process_sample_unlocked(x);
+        keep(a);
+    });
+    std::vector<double> ofi_int(ofi.size());
+    for (size_t i = 0; i < ofi.size(); ++i) ofi_int[i] = std::round(ofi[i]);
+    bench_static_predictor<EwmaDouble>("predictor/static/double", ofi_int);
+    bench_static_predictor<EwmaFloat>("predictor/static/float", ofi_int);
+    bench_static_predictor<EwmaFixed<ENGINE_Q_BITS>>("predictor/static/fixed_q16", ofi_int);
+
+    std::vector<BankConfig> grid;
+    for (int a = 1; a <= 16; ++a) {
+        for (int t = 1; t <= 16; ++t) grid.push_back({0.01 * a, 10.0 * t});
+    }
+    PredictorBank bank(grid, 64);
+    bench("bank/update_n256_sym64", ofi.size(), [&] {
+        int v = 0;
+        for (size_t i = 0; i < ofi.size(); ++i) v += bank.update(uint32_t(i & 63), ofi[i]);
+        keep(v);
+    });
+
+    SymbolStore store(64, 0.15, 40.0);
+    bench("store/process_sample_sym64", ofi.size(), [&] {
+        int a = 0;
+        for (size_t i = 0; i < ofi.size(); ++i) a += store.process_sample(uint32_t(i & 63), ofi[i]);
+        keep(a);
+    });
+    for (PredictorKind k : {PredictorKind::StaticDouble, PredictorKind::StaticFloat, PredictorKind::StaticFixed}) {
+        SymbolStore st(64, ENGINE_ALPHA, ENGINE_THRESHOLD);
+        st.set_predictor(k);
+        bench(std::string("store/process_sample_sym64/") + predictor_kind_name(k), ofi_int.size(), [&] {
+            int a = 0;
+            for (size_t i = 0; i < ofi_int.size(); ++i) a += st.process_sample(uint32_t(i & 63), ofi_int[i]);
+            keep(a);
+        });
+    }
+
+    // every feature on every tick, recv_ts 50us apart: the time windows stay full
+    FeatureEngine fe(FeatureConfig{}, 64);
+    double fts = 0.0;
+    bench("features/update_sym64", ofi_int.size(), [&] {
+        double v = 0.0;
+        for (size_t i = 0; i < ofi_int.size(); ++i) v += fe.update(uint32_t(i & 63), ofi_int[i], fts += 50e-6)[0];
+        keep(v);
+    });
+
+    struct Shape { size_t seqs, len; };
+    const Shape shapes[] = {{64, 1024}, {1024, 1024}, {16, 65536}, {1, 1 << 20}};
+    // single-threaded, and on every core when there is more than one
+    std::vector<size_t> thread_counts{1};
+    if (std::thread::hardware_concurrency() > 1) thread_counts.push_back(std::thread::hardware_concurrency());
+    for (BatchKernel k : {BatchKernel::Scalar, BatchKernel::Auto}) {
+        for (size_t threads : thread_counts) {
+            for (const Shape& sh : shapes) {
+                std::string name = std::string("predictor/process_batch/") +
+                                   (k == BatchKernel::Auto ? batch_kernel_name(detect_batch_kernel())
+                                                           : batch_kernel_name(k)) +
+                                   "/t" + std::to_string(threads) + "/" + std::to_string(sh.seqs) + "x" +
+                                   std::to_string(sh.len);
+                if (!selected(name)) continue;
+                std::vector<double> data(sh.seqs * sh.len);
+                for (double& x : data) x = nd(rng);
+                std::vector<int> out;
+                Predictor p(0.15, 40.0);
+                p.set_batch_kernel(k);
+                p.set_batch_threads(threads);
+                bench(name, data.size(), [&] {
+                    p.process_batch(data, sh.seqs, sh.len, out);
+                    keep(out.data());
+                });
+            }
+        }
+    }
+}
+
+// Loopback end to end: a sender thread streams ticks to 127.0.0.1; the receiver runs the
+// same UdpIngest -> Engine::decode -> Engine::process loop as main.cpp. Latency is wall
+// clock at decision minus the sender's src_ts, so it covers send, kernel, receive and compute.
+// `busy_poll` spins on the socket like --low-latency; `wakeup` turns on kernel receive
+// timestamps and adds the kernel -> user-space delay percentiles (receive jitter).
+void bench_e2e(const std::string& name, size_t per_dgram, double rate_hz, bool busy_poll = false, bool wakeup = false) {
+    if (!selected(name)) return;
+    const size_t total = opt.quick ? std::min<size_t>(opt.e2e_ticks, 100000) : opt.e2e_ticks;
+
+    int rx = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t alen = sizeof(addr);
+    int rcvbuf = 16 << 20;
+    setsockopt(rx, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    timeval tv{0, 200000};  // receive loop wakes up to notice the end of the run
+    setsockopt(rx, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    if (rx < 0 || bind(rx, (sockaddr*)&addr, sizeof(addr)) < 0 || getsockname(rx, (sockaddr*)&addr, &alen) < 0) {
+        perror("bench e2e: socket");
+        if (rx >= 0) close(rx);
+        return;
+    }
+
+    UdpIngest ingest(rx, 64, 2047, wakeup ? UdpIngest::TimestampMode::KernelNs : UdpIngest::TimestampMode::User);
+    ingest.init();
+    ingest.set_busy_poll(busy_poll);
+    EngineConfig cfg;
+    cfg.report_interval_s = 0.0;
+    Engine engine(cfg);
+
+    const auto trades = make_trades(4096, 16, 7);
+    std::atomic<bool> sent_all{false};
+    std::thread sender([&] {
+        int tx = socket(AF_INET, SOCK_DGRAM, 0);
+        connect(tx, (sockaddr*)&addr, sizeof(addr));
+        std::vector<char> buf(sizeof(BinaryTickHeader) + per_dgram * sizeof(BinaryTickV2) + 128);
+        std::vector<Tick> batch(per_dgram);
+        const double interval = rate_hz > 0.0 ? double(per_dgram) / rate_hz : 0.0;
+        auto start = steady_clock::now();
+        for (size_t seq = 0, k = 0; seq < total; ++k) {
+            if (interval > 0.0) {
+                auto due = start + std::chrono::duration_cast<steady_clock::duration>(
+                                       std::chrono::duration<double>(double(k) * interval));
+                while (steady_clock::now() < due) {}
+            }
+            size_t n = std::min(per_dgram, total - seq);
+            double ts = wall_now();
+            for (size_t i = 0; i < n; ++i) {
+                batch[i] = trades[(seq + i) % trades.size()];
+                batch[i].seq = seq + i;
+                batch[i].src_ts = ts;
+            }
+            size_t len;
+            if (per_dgram == 1) {
+                const Tick& t = batch[0];
+                len = size_t(std::snprintf(buf.data(), buf.size(), "%llu,%.9f,%.6f,%u,SYM%u\n",
+                                           (unsigned long long)t.seq, t.src_ts, t.price, t.size, t.symbol));
+            } else {
+                len = encode_binary_ticks(batch.data(), n, buf.data(), buf.size());
+            }
+            send(tx, buf.data(), len, 0);
+            seq += n;
+        }
+        close(tx);
+        sent_all.store(true, std::memory_order_release);
+    });
+
+    LatencyHistogram lat;
+    Decision d;
+    uint64_t received = 0;
+    steady_clock::time_point first{}, last{};
+    auto on_tick = [&](const Tick& t) {
+        engine.process(t, d);
+        lat.record_signed(int64_t((wall_now() - t.src_ts) * 1e9));
+        ++received;
+    };
+    auto last_data = steady_clock::now();
+    while (received < total) {
+        int got = ingest.receive_batch();
+        if (got == 0) {
+            // sender finished and nothing arrived for a few receive timeouts: the rest was lost
+            if (sent_all.load(std::memory_order_acquire) &&
+                steady_clock::now() - last_data > std::chrono::milliseconds(600)) {
+                break;
+            }
+            continue;
+        }
+        last_data = steady_clock::now();
+        if (received == 0) first = steady_clock::now();
+        for (int i = 0; i < got; ++i) engine.decode(ingest.data(i), ingest.length(i), ingest.recv_ts(i), on_tick);
+        last = steady_clock::now();
+    }
+    sender.join();
+    close(rx);
+
+    double secs = std::chrono::duration<double>(last - first).count();
+    if (wakeup) {
+        const LatencyHistogram& w = ingest.kernel_to_user_ns();
+        emit(name, {{"ticks_received", double(received)},
+                    {"lost", double(total - received)},
+                    {"wake_p50_ns", double(w.percentile(0.5))},
+                    {"wake_p90_ns", double(w.percentile(0.9))},
+                    {"wake_p99_ns", double(w.percentile(0.99))},
+                    {"wake_p999_ns", double(w.percentile(0.999))},
+                    {"wake_max_ns", double(w.max())},
+                    {"p50_ns", double(lat.percentile(0.5))},
+                    {"p99_ns", double(lat.percentile(0.99))}});
+        return;
+    }
+    emit(name, {{"ticks_sent", double(total)},
+                {"ticks_received", double(received)},
+                {"lost", double(total - received)},
+                {"ticks_per_s", secs > 0.0 ? double(received) / secs : 0.0},
+                {"avg_batch", ingest.syscalls() ? double(ingest.datagrams()) / double(ingest.syscalls()) : 0.0},
+                {"p50_ns", double(lat.percentile(0.5))},
+                {"p99_ns", double(lat.percentile(0.99))},
+                {"p999_ns", double(lat.percentile(0.999))},
+                {"max_ns", double(lat.max())}});
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        std::string a(argv[i]);
+        if (a.rfind("--filter=", 0) == 0) {
+            opt.filter = a.substr(9);
+        } else if (a == "--json") {
+            opt.json = true;
+        } else if (a == "--quick") {
+            opt.quick = true;
+        } else if (a.rfind("--e2e-ticks=", 0) == 0) {
+            long n = std::atol(a.substr(12).c_str());
+            if (n > 0) opt.e2e_ticks = size_t(n);
+        } else {
+            std::fprintf(stderr, "usage: %s [--filter=<substr>] [--json] [--quick] [--e2e-ticks=<n>]\n", argv[0]);
+            return 2;
+        }
+    }
+
+#ifdef __OPTIMIZE__
+    const double optimized = 1.0;
+#else
+    const double optimized = 0.0;
+    std::fprintf(stderr, "warning: benchmark built without optimisation (use CMAKE_BUILD_TYPE=Release)\n");
+#endif
+    // Engine::process times itself with TscClock, as in the daemon
+    TscClock::calibrate();
+    emit("info", {{"optimized", optimized},
+                  {"hw_threads", double(std::thread::hardware_concurrency())},
+                  {"simd_width", detect_batch_kernel() == BatchKernel::Avx512 ? 8.0
+                                 : detect_batch_kernel() == BatchKernel::Avx2 ? 4.0 : 1.0},
+                  {"tsc_ghz", TscClock::tsc() ? TscClock::ticks_per_s() / 1e9 : 0.0}});
+
+    bench_clock();
+    bench_parsing();
+    bench_ofi();
+    bench_book();
+    bench_predictor();
+    bench_metrics();
+    bench_store();
+    // unthrottled: maximum sustained rate (drops show up as `lost`);
+    // paced: latency at a load the receiver keeps up with
+    bench_e2e("e2e/binary_x32/max", 32, 0.0);
+    bench_e2e("e2e/csv_x1/max", 1, 0.0);
+    bench_e2e("e2e/binary_x32/paced_200k", 32, 200000.0);
+    // receive jitter, blocking recvmmsg vs --low-latency busy poll (needs a spare core to mean much)
+    bench_e2e("e2e/csv_x1/paced_20k/blocking", 1, 20000.0, false, true);
+    bench_e2e("e2e/csv_x1/paced_20k/busy_poll", 1, 20000.0, true, true);
+    return 0;
+}
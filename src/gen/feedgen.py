@@ -1,33 +1,120 @@
 #!/usr/bin/env python3
-# feedgen.py -- simple UDP tick generator (CSV lines)
-# Usage: python3 feedgen.py [host] [port] [rate_hz]
+# feedgen.py -- simple UDP tick generator (CSV lines or binary records)
+# Usage: python3 feedgen.py [host] [port] [rate_hz] [--binary] [--batch=N] [--symbol=ID] [--symbols=N]
+#   --binary     emit the binary wire format (see src/main/parser/BinaryTick.h)
+#   --batch=N    binary only: pack N ticks per datagram (rate_hz still counts ticks)
+#   --symbol=ID  binary only: symbol id carried in each record (first id when --symbols > 1)
+#   --symbols=N  round-robin N instruments, each with its own price walk;
+#                CSV lines gain a fifth field SYM<k>, binary records use ids ID..ID+N-1
+#   --book       binary only: emit L2 add/modify/delete quote updates (5 levels a side,
+#                0.01 tick) instead of trades
 # print("HELLO")
-import socket, time, random, sys
+import socket, time, random, sys, struct
 
-HOST = sys.argv[1] if len(sys.argv) > 1 else '127.0.0.1'
-PORT = int(sys.argv[2]) if len(sys.argv) > 2 else 9000
-RATE_HZ = float(sys.argv[3]) if len(sys.argv) > 3 else 2000.0
+flags = [a for a in sys.argv[1:] if a.startswith('--')]
+args = [a for a in sys.argv[1:] if not a.startswith('--')]
+
+HOST = args[0] if len(args) > 0 else '127.0.0.1'
+PORT = int(args[1]) if len(args) > 1 else 9000
+RATE_HZ = float(args[2]) if len(args) > 2 else 2000.0
+
+BOOK = '--book' in flags
+BINARY = '--binary' in flags or BOOK
+BATCH = 1
+SYMBOL = 0
+NSYM = 1
+for f in flags:
+    if f.startswith('--batch='):
+        BATCH = max(1, min(int(f[8:]), 40))  # 40 * 34 bytes stays well under the receiver's 2k buffer
+    elif f.startswith('--symbol='):
+        SYMBOL = int(f[9:])
+    elif f.startswith('--symbols='):
+        NSYM = max(1, int(f[10:]))
+
+# binary layout: header <magic u8, version u8, count u16>,
+# v2 records <seq u64, src_ts f64, price f64, size u32, symbol u32, side i8, type u8>
+BIN_MAGIC = 0xF1
+BIN_VERSION = 2
+BIN_HEADER = struct.Struct('<BBH')
+BIN_RECORD = struct.Struct('<QddIIbB')
+T_TRADE, T_ADD, T_MODIFY, T_DELETE = 0, 1, 2, 3
+
+TICK = 0.01
+LEVELS = 5
+
+class Book:
+    """Toy 5-level book with a one-tick spread; yields (price, size, side, type) updates."""
+    def __init__(self, px):
+        self.bid = int(round(px / TICK))
+        self.pending = []
+        for i in range(LEVELS):
+            self.pending.append(((self.bid - i) * TICK, random.randint(1, 1000), 1, T_ADD))
+            self.pending.append(((self.bid + 1 + i) * TICK, random.randint(1, 1000), -1, T_ADD))
+
+    def next(self):
+        if not self.pending:
+            r = random.random()
+            b, a = self.bid, self.bid + 1
+            if r < 0.05:
+                # ask lifted: best ask level becomes the new best bid
+                self.pending += [(a * TICK, 0, -1, T_DELETE), (a * TICK, random.randint(1, 1000), 1, T_ADD),
+                                 ((a + LEVELS) * TICK, random.randint(1, 1000), -1, T_ADD),
+                                 ((b - LEVELS + 1) * TICK, 0, 1, T_DELETE)]
+                self.bid += 1
+            elif r < 0.10:
+                # bid hit: best bid level becomes the new best ask
+                self.pending += [(b * TICK, 0, 1, T_DELETE), (b * TICK, random.randint(1, 1000), -1, T_ADD),
+                                 ((b - LEVELS) * TICK, random.randint(1, 1000), 1, T_ADD),
+                                 ((a + LEVELS - 1) * TICK, 0, -1, T_DELETE)]
+                self.bid -= 1
+            else:
+                side = random.choice((1, -1))
+                lvl = min(int(random.expovariate(1.0)), LEVELS - 1)
+                px = (b - lvl) if side == 1 else (a + lvl)
+                self.pending.append((px * TICK, random.randint(1, 1000), side, T_MODIFY))
+        return self.pending.pop(0)
 
 sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
 addr = (HOST, PORT)
 
 seq = 0
-price = 100.0
+prices = [100.0] * NSYM
+books = [Book(100.0) for _ in range(NSYM)] if BOOK else None
 
-interval = 1.0 / RATE_HZ
-print(f"Sending ticks to {HOST}:{PORT} at {RATE_HZ} hz (interval {interval:.6f}s)")
+if not BINARY:
+    BATCH = 1
+interval = BATCH / RATE_HZ
+fmt = (f"binary x{BATCH}" + (" book" if BOOK else "")) if BINARY else "csv"
+print(f"Sending ticks to {HOST}:{PORT} at {RATE_HZ} hz ({fmt}, interval {interval:.6f}s)")
 
 try:
     while True:
-        ts = time.time()
-        price += random.gauss(-0.5, 0.5)
-        size = random.randint(1, 1000)
-        line = f"{seq},{ts:.9f},{price:.6f},{size}\n"
-        sock.sendto(line.encode('utf-8'), addr)
-        seq += 1
+        if BINARY:
+            records = []
+            for _ in range(BATCH):
+                k = seq % NSYM
+                ts = time.time()
+                if BOOK:
+                    px, size, side, typ = books[k].next()
+                else:
+                    delta = random.gauss(-0.5, 0.5)
+                    prices[k] += delta
+                    px, size, side, typ = prices[k], random.randint(1, 1000), (1 if delta > 0 else -1), T_TRADE
+                records.append(BIN_RECORD.pack(seq, ts, px, size, SYMBOL + k, side, typ))
+                seq += 1
+            sock.sendto(BIN_HEADER.pack(BIN_MAGIC, BIN_VERSION, len(records)) + b''.join(records), addr)
+        else:
+            k = seq % NSYM
+            ts = time.time()
+            prices[k] += random.gauss(-0.5, 0.5)
+            size = random.randint(1, 1000)
+            sym = f",SYM{k}" if NSYM > 1 else ""
+            line = f"{seq},{ts:.9f},{prices[k]:.6f},{size}{sym}\n"
+            sock.sendto(line.encode('utf-8'), addr)
+            seq += 1
         time.sleep(interval)
 
 except KeyboardInterrupt:
     print("\nTerminated by user.")
     sock.close()
-    sys.exit(0)
\ No newline at end of file
+    sys.exit(0)
@@ -0,0 +1,483 @@
+// flow_imbalance_loadgen -- high-rate UDP tick generator for stress tests (feedgen.py tops out
+// at a few thousand ticks/s)
+// Usage: flow_imbalance_loadgen [host] [port] [rate_hz] [options]
+//   rate_hz            ticks/s summed over all threads (default 100000)
+//   --binary           binary wire format (src/main/parser/BinaryTick.h) instead of CSV lines
+//   --batch=<n>        binary only: ticks per datagram, 1..60 (fits the receiver's 2 KiB buffer)
+//   --symbols=<n>      instruments, each with its own price/size walk (default 1); CSV lines
+//                      gain a fifth field SYM<k> when n > 1, binary ids are --symbol + k
+//   --symbol=<id>      binary only: first symbol id (default 0)
+//   --profile=constant|poisson|burst
+//                      datagram spacing: fixed, exponential (Poisson arrivals) or a square
+//                      wave alternating --burst rate and rate_hz
+//   --burst=<hz>:<on_ms>:<off_ms>
+//                      burst profile: <hz> for on_ms, then rate_hz for off_ms
+//                      (default 10 x rate_hz, 50 ms on, 950 ms off)
+//   --threads=<n>      sender threads, each with its own socket (so its own source port, which
+//                      spreads load over --shards) and 1/n of the rate; symbol k is sent by
+//                      thread k mod n, so n <= --symbols (default 1)
+//   --mmsg=<n>         max datagrams per sendmmsg call (default 64)
+//   --seed=<n>         walk seed (default 1): the same seed gives every symbol the same
+//                      price/size sequence, whatever the thread count
+//   --count=<n>        stop after n ticks (default 0 = no limit)
+//   --duration=<sec>   stop after sec seconds (default 0 = until Ctrl+C)
+//   --echo-port=<p>    collect acks from `flow_imbalance --echo=<this host>:<p>` and report the
+//                      closed-loop round trip src_ts -> ack
+//
+// Datagrams are due at absolute offsets from the start, so rounding never accumulates into
+// rate drift. Everything due by the time a sender wakes goes out in one sendmmsg call; a
+// sender that cannot keep up reports its lag instead of silently sending slower. seq is
+// shared by all threads (one atomic add per datagram), so the receiver sees one publisher
+// whose datagrams may interleave slightly out of order across threads.
+// Output: LOADGEN key=value lines on exit.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "main/ingest/Echo.h"
+#include "main/parser/BinaryTick.h"
+#include "main/stats/LatencyHistogram.h"
+
+static std::atomic<bool> keep_running{true};
+static void sigint_handler(int) { keep_running = false; }
+
+namespace {
+
+using steady_clock = std::chrono::steady_clock;
+
+constexpr size_t DATAGRAM_CAP = 2047;  // the receiver's buffer (UdpIngest, BUF_SZ - 1)
+constexpr size_t MAX_BATCH = (DATAGRAM_CAP - sizeof(BinaryTickHeader)) / sizeof(BinaryTickV2);
+constexpr double PRICE_TICK = 0.01;
+
+double wall_now() {
+    return std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+struct Options {
+    std::string host = "127.0.0.1";
+    int port = 9000;
+    double rate = 100000.0;
+    bool binary = false;
+    size_t batch = 1;
+    uint32_t symbols = 1;
+    uint32_t first_symbol = 0;
+    enum class Profile { Constant, Poisson, Burst } profile = Profile::Constant;
+    double burst_rate = 0.0;  // 0 = 10 x rate
+    double burst_on_s = 0.05;
+    double burst_off_s = 0.95;
+    size_t threads = 1;
+    size_t mmsg = 64;
+    uint64_t seed = 1;
+    uint64_t count = 0;
+    double duration = 0.0;
+    int echo_port = 0;
+};
+
+const char* profile_name(Options::Profile p) {
+    switch (p) {
+        case Options::Profile::Poisson: return "poisson";
+        case Options::Profile::Burst: return "burst";
+        default: return "constant";
+    }
+}
+
+// Gaussian tick-sized steps around 100.0 and uniform sizes; one generator per symbol
+class SymbolWalk {
+public:
+    SymbolWalk(uint64_t seed, uint32_t symbol) : rng_(seed * 0x9E3779B97F4A7C15ull + symbol + 1) {}
+
+    void next(Tick& t) {
+        const double step = std::round(step_(rng_));
+        price_ = std::max(PRICE_TICK, price_ + step * PRICE_TICK);
+        t.price = price_;
+        t.size = size_(rng_);
+        t.side = step > 0.0 ? 1 : -1;
+        t.type = TickType::Trade;
+    }
+
+private:
+    std::mt19937_64 rng_;
+    std::normal_distribution<double> step_{0.0, 2.0};
+    std::uniform_int_distribution<uint32_t> size_{1, 1000};
+    double price_ = 100.0;
+};
+
+// seconds from a datagram due at `t` (since start) to the next one
+class RateProfile {
+public:
+    RateProfile(const Options& o, double share, uint64_t seed)
+        : kind_(o.profile), rate_(o.rate * share), burst_rate_((o.burst_rate > 0.0 ? o.burst_rate : 10.0 * o.rate) * share),
+          on_s_(o.burst_on_s), period_s_(o.burst_on_s + o.burst_off_s), ticks_(double(o.batch)), rng_(seed) {}
+
+    double gap(double t) {
+        switch (kind_) {
+            case Options::Profile::Poisson:
+                return std::exponential_distribution<double>(rate_ / ticks_)(rng_);
+            case Options::Profile::Burst:
+                return ticks_ / (std::fmod(t, period_s_) < on_s_ ? burst_rate_ : rate_);
+            default:
+                return ticks_ / rate_;
+        }
+    }
+
+private:
+    Options::Profile kind_;
+    double rate_, burst_rate_, on_s_, period_s_, ticks_;
+    std::mt19937_64 rng_;
+};
+
+struct SenderStats {
+    uint64_t datagrams = 0;
+    uint64_t ticks = 0;
+    uint64_t syscalls = 0;
+    uint64_t errors = 0;  // datagrams the kernel refused (ENOBUFS, ECONNREFUSED, ...)
+    double max_lag_s = 0.0;
+    double elapsed_s = 0.0;
+};
+
+class Sender {
+public:
+    Sender(const Options& o, size_t id, const sockaddr_in& dest, std::atomic<uint64_t>& next_seq)
+        : o_(o), id_(id), dest_(dest), next_seq_(next_seq), profile_(o, 1.0 / double(o.threads), o.seed + 1000 + id),
+          bufs_(o.mmsg * DATAGRAM_CAP), iov_(o.mmsg), msgs_(o.mmsg), ticks_(o.batch) {
+        for (uint32_t k = uint32_t(id); k < o.symbols; k += uint32_t(o.threads)) {
+            symbols_.push_back(k);
+            walks_.emplace_back(o.seed, k);
+        }
+        for (size_t i = 0; i < o.mmsg; ++i) {
+            iov_[i].iov_base = &bufs_[i * DATAGRAM_CAP];
+            std::memset(&msgs_[i], 0, sizeof(mmsghdr));
+            msgs_[i].msg_hdr.msg_iov = &iov_[i];
+            msgs_[i].msg_hdr.msg_iovlen = 1;
+        }
+    }
+    ~Sender() {
+        if (sock_ >= 0) close(sock_);
+    }
+
+    bool open() {
+        sock_ = socket(AF_INET, SOCK_DGRAM, 0);
+        int sndbuf = 8 << 20;
+        if (sock_ >= 0) setsockopt(sock_, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+        if (sock_ < 0 || connect(sock_, reinterpret_cast<const sockaddr*>(&dest_), sizeof(dest_)) < 0) {
+            perror("loadgen: socket/connect");
+            return false;
+        }
+        return true;
+    }
+
+    void start(steady_clock::time_point t0) { thread_ = std::thread([this, t0] { run(t0); }); }
+    void join() {
+        if (thread_.joinable()) thread_.join();
+    }
+    const SenderStats& stats() const { return stats_; }
+
+private:
+    const Options& o_;
+    size_t id_;
+    sockaddr_in dest_;
+    std::atomic<uint64_t>& next_seq_;
+    RateProfile profile_;
+    int sock_ = -1;
+    std::vector<uint32_t> symbols_;
+    std::vector<SymbolWalk> walks_;
+    size_t next_symbol_ = 0;
+    std::vector<char> bufs_;
+    std::vector<iovec> iov_;
+    std::vector<mmsghdr> msgs_;
+    std::vector<Tick> ticks_;
+    SenderStats stats_;
+    std::thread thread_;
+
+    // fill datagram slot i; false once --count is reached
+    bool build(size_t i, double src_ts) {
+        const uint64_t seq0 = next_seq_.fetch_add(o_.batch, std::memory_order_relaxed);
+        size_t n = o_.batch;
+        if (o_.count > 0) {
+            if (seq0 >= o_.count) return false;
+            n = size_t(std::min<uint64_t>(n, o_.count - seq0));
+        }
+        char* buf = &bufs_[i * DATAGRAM_CAP];
+        size_t len = 0;
+        for (size_t k = 0; k < n; ++k) {
+            const size_t s = next_symbol_;
+            next_symbol_ = next_symbol_ + 1 == symbols_.size() ? 0 : next_symbol_ + 1;
+            Tick& t = ticks_[k];
+            walks_[s].next(t);
+            t.seq = seq0 + k;
+            t.src_ts = src_ts;
+            t.symbol = o_.first_symbol + symbols_[s];
+            if (!o_.binary) {
+                len = o_.symbols > 1
+                          ? size_t(std::snprintf(buf, DATAGRAM_CAP, "%llu,%.9f,%.6f,%u,SYM%u\n", (unsigned long long)t.seq,
+                                                 t.src_ts, t.price, t.size, symbols_[s]))
+                          : size_t(std::snprintf(buf, DATAGRAM_CAP, "%llu,%.9f,%.6f,%u\n", (unsigned long long)t.seq,
+                                                 t.src_ts, t.price, t.size));
+            }
+        }
+        if (o_.binary) len = encode_binary_ticks(ticks_.data(), n, buf, DATAGRAM_CAP);
+        iov_[i].iov_len = len;
+        stats_.ticks += n;
+        return true;
+    }
+
+    void run(steady_clock::time_point t0) {
+        const auto elapsed = [t0] { return std::chrono::duration<double>(steady_clock::now() - t0).count(); };
+        double due = 0.0;
+        bool more = true;
+        while (more && keep_running.load(std::memory_order_relaxed)) {
+            double now = elapsed();
+            if (o_.duration > 0.0 && due >= o_.duration) break;
+            if (due > now) {
+                // sleep through long gaps, spin the last stretch so pacing stays tight
+                if (due - now > 200e-6) std::this_thread::sleep_for(std::chrono::duration<double>(due - now - 100e-6));
+                while ((now = elapsed()) < due) {}
+            }
+            stats_.max_lag_s = std::max(stats_.max_lag_s, now - due);
+            // everything due by now goes out in one call
+            size_t n = 0;
+            const double src_ts = wall_now();
+            while (n < o_.mmsg && due <= now) {
+                if (!build(n, src_ts)) {
+                    more = false;
+                    break;
+                }
+                ++n;
+                due += profile_.gap(due);
+            }
+            for (size_t off = 0; off < n;) {
+                int r = sendmmsg(sock_, &msgs_[off], unsigned(n - off), 0);
+                ++stats_.syscalls;
+                if (r < 0) {
+                    if (errno == EINTR) continue;
+                    // the first datagram failed (ECONNREFUSED: no listener yet, ENOBUFS): count it, send the rest
+                    ++stats_.errors;
+                    ++off;
+                    continue;
+                }
+                stats_.datagrams += unsigned(r);
+                off += size_t(r);
+            }
+        }
+        stats_.elapsed_s = elapsed();
+    }
+};
+
+// receives EchoRecords until stopped; round trip measured on this host's clock
+class EchoCollector {
+public:
+    // an early return in main() must not leave the collector thread joinable
+    ~EchoCollector() { stop(); }
+
+    bool open(int port) {
+        sock_ = socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons(uint16_t(port));
+        timeval tv{0, 100000};
+        if (sock_ < 0 || bind(sock_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+            setsockopt(sock_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) < 0) {
+            perror("loadgen: echo socket");
+            return false;
+        }
+        thread_ = std::thread([this] { run(); });
+        return true;
+    }
+    void stop() {
+        stop_ = true;
+        if (thread_.joinable()) thread_.join();
+        if (sock_ >= 0) close(sock_);
+        sock_ = -1;
+    }
+
+    uint64_t acks = 0, bad = 0, buy = 0, sell = 0;
+    LatencyHistogram rtt_ns, in_ns, engine_ns, out_ns;
+
+private:
+    int sock_ = -1;
+    std::atomic<bool> stop_{false};
+    std::thread thread_;
+
+    void run() {
+        EchoRecord r;
+        while (!stop_.load(std::memory_order_relaxed)) {
+            ssize_t n = recv(sock_, &r, sizeof(r), 0);
+            const double now = wall_now();
+            if (n < 0) continue;
+            if (n != ssize_t(sizeof(r)) || r.magic != ECHO_MAGIC) {
+                ++bad;
+                continue;
+            }
+            ++acks;
+            if (r.action > 0) ++buy;
+            else if (r.action < 0) ++sell;
+            rtt_ns.record_signed(int64_t((now - r.src_ts) * 1e9));
+            in_ns.record_signed(int64_t((r.recv_ts - r.src_ts) * 1e9));
+            engine_ns.record_signed(int64_t((r.send_ts - r.recv_ts) * 1e9));
+            out_ns.record_signed(int64_t((now - r.send_ts) * 1e9));
+        }
+    }
+};
+
+void print_latency(const char* name, const LatencyHistogram& h) {
+    std::printf("LOADGEN %s count=%llu p50=%.2f p90=%.2f p99=%.2f p99.9=%.2f max=%.2f mean=%.2f\n", name,
+                (unsigned long long)h.count(), h.percentile(0.5) / 1e3, h.percentile(0.9) / 1e3,
+                h.percentile(0.99) / 1e3, h.percentile(0.999) / 1e3, h.max() / 1e3, h.mean() / 1e3);
+}
+
+bool parse_args(int argc, char** argv, Options& o) {
+    std::vector<std::string> pos;
+    for (int i = 1; i < argc; ++i) {
+        std::string a(argv[i]);
+        if (a.rfind("--", 0) != 0) {
+            pos.push_back(a);
+        } else if (a == "--binary") {
+            o.binary = true;
+        } else if (a.rfind("--batch=", 0) == 0) {
+            o.batch = size_t(std::max(1, std::atoi(a.c_str() + 8)));
+        } else if (a.rfind("--symbols=", 0) == 0) {
+            o.symbols = uint32_t(std::max(1, std::atoi(a.c_str() + 10)));
+        } else if (a.rfind("--symbol=", 0) == 0) {
+            o.first_symbol = uint32_t(std::strtoul(a.c_str() + 9, nullptr, 10));
+        } else if (a.rfind("--profile=", 0) == 0) {
+            const std::string p = a.substr(10);
+            if (p == "constant") o.profile = Options::Profile::Constant;
+            else if (p == "poisson") o.profile = Options::Profile::Poisson;
+            else if (p == "burst") o.profile = Options::Profile::Burst;
+            else return false;
+        } else if (a.rfind("--burst=", 0) == 0) {
+            double hz = 0.0, on = 0.0, off = 0.0;
+            if (std::sscanf(a.c_str() + 8, "%lf:%lf:%lf", &hz, &on, &off) != 3 || hz <= 0.0 || on <= 0.0 || off < 0.0) {
+                return false;
+            }
+            o.burst_rate = hz;
+            o.burst_on_s = on / 1e3;
+            o.burst_off_s = off / 1e3;
+            o.profile = Options::Profile::Burst;
+        } else if (a.rfind("--threads=", 0) == 0) {
+            o.threads = size_t(std::max(1, std::atoi(a.c_str() + 10)));
+        } else if (a.rfind("--mmsg=", 0) == 0) {
+            o.mmsg = size_t(std::max(1, std::atoi(a.c_str() + 7)));
+        } else if (a.rfind("--seed=", 0) == 0) {
+            o.seed = std::strtoull(a.c_str() + 7, nullptr, 10);
+        } else if (a.rfind("--count=", 0) == 0) {
+            o.count = std::strtoull(a.c_str() + 8, nullptr, 10);
+        } else if (a.rfind("--duration=", 0) == 0) {
+            o.duration = std::max(0.0, std::atof(a.c_str() + 11));
+        } else if (a.rfind("--echo-port=", 0) == 0) {
+            o.echo_port = std::atoi(a.c_str() + 12);
+        } else {
+            return false;
+        }
+    }
+    if (pos.size() > 0) o.host = pos[0];
+    if (pos.size() > 1) o.port = std::atoi(pos[1].c_str());
+    if (pos.size() > 2) o.rate = std::atof(pos[2].c_str());
+    if (!o.binary) o.batch = 1;
+    o.batch = std::min(o.batch, MAX_BATCH);
+    return o.rate > 0.0 && o.port > 0 && o.port < 65536;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options o;
+    if (!parse_args(argc, argv, o)) {
+        std::fprintf(stderr,
+                     "usage: %s [host] [port] [rate_hz] [--binary] [--batch=N] [--symbols=N] [--symbol=ID]\n"
+                     "          [--profile=constant|poisson|burst] [--burst=HZ:ON_MS:OFF_MS] [--threads=N]\n"
+                     "          [--mmsg=N] [--seed=N] [--count=N] [--duration=SEC] [--echo-port=P]\n",
+                     argv[0]);
+        return 2;
+    }
+    if (o.threads > o.symbols) {
+        std::fprintf(stderr, "--threads=%zu needs at least as many --symbols (%u): each symbol's walk has one sender\n",
+                     o.threads, o.symbols);
+        return 2;
+    }
+    sockaddr_in dest;
+    std::memset(&dest, 0, sizeof(dest));
+    dest.sin_family = AF_INET;
+    dest.sin_port = htons(uint16_t(o.port));
+    if (inet_pton(AF_INET, o.host.c_str(), &dest.sin_addr) != 1) {
+        std::fprintf(stderr, "loadgen: %s is not an IPv4 address\n", o.host.c_str());
+        return 2;
+    }
+    signal(SIGINT, sigint_handler);
+
+    EchoCollector echo;
+    if (o.echo_port > 0 && !echo.open(o.echo_port)) return 1;
+
+    std::atomic<uint64_t> next_seq{0};
+    std::vector<std::unique_ptr<Sender>> senders;
+    for (size_t i = 0; i < o.threads; ++i) {
+        senders.emplace_back(new Sender(o, i, dest, next_seq));
+        if (!senders.back()->open()) return 1;
+    }
+    std::printf("Sending ticks to %s:%d at %.0f hz (%s x%zu, %s", o.host.c_str(), o.port, o.rate,
+                o.binary ? "binary" : "csv", o.batch, profile_name(o.profile));
+    if (o.profile == Options::Profile::Burst) {
+        std::printf(" %.0f hz for %.0f ms every %.0f ms", o.burst_rate > 0.0 ? o.burst_rate : 10.0 * o.rate,
+                    o.burst_on_s * 1e3, (o.burst_on_s + o.burst_off_s) * 1e3);
+    }
+    std::printf(", %zu threads, %u symbols, seed %llu)\n", o.threads, o.symbols, (unsigned long long)o.seed);
+    std::fflush(stdout);
+
+    const auto t0 = steady_clock::now();
+    for (auto& s : senders) s->start(t0);
+    for (auto& s : senders) s->join();
+    if (o.echo_port > 0) {
+        // acks for the last ticks are still in flight
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        echo.stop();
+    }
+
+    SenderStats total;
+    for (size_t i = 0; i < senders.size(); ++i) {
+        const SenderStats& s = senders[i]->stats();
+        std::printf("LOADGEN thread=%zu datagrams=%llu ticks=%llu syscalls=%llu avg_batch=%.2f errors=%llu "
+                    "ticks_per_s=%.0f max_lag_us=%.1f\n",
+                    i, (unsigned long long)s.datagrams, (unsigned long long)s.ticks, (unsigned long long)s.syscalls,
+                    s.syscalls ? double(s.datagrams) / double(s.syscalls) : 0.0, (unsigned long long)s.errors,
+                    s.elapsed_s > 0.0 ? double(s.ticks) / s.elapsed_s : 0.0, s.max_lag_s * 1e6);
+        total.datagrams += s.datagrams;
+        total.ticks += s.ticks;
+        total.syscalls += s.syscalls;
+        total.errors += s.errors;
+        total.max_lag_s = std::max(total.max_lag_s, s.max_lag_s);
+        total.elapsed_s = std::max(total.elapsed_s, s.elapsed_s);
+    }
+    std::printf("LOADGEN total datagrams=%llu ticks=%llu errors=%llu elapsed_s=%.3f ticks_per_s=%.0f max_lag_us=%.1f\n",
+                (unsigned long long)total.datagrams, (unsigned long long)total.ticks, (unsigned long long)total.errors,
+                total.elapsed_s, total.elapsed_s > 0.0 ? double(total.ticks) / total.elapsed_s : 0.0,
+                total.max_lag_s * 1e6);
+    if (o.echo_port > 0) {
+        std::printf("LOADGEN echo acks=%llu buy=%llu sell=%llu bad=%llu\n", (unsigned long long)echo.acks,
+                    (unsigned long long)echo.buy, (unsigned long long)echo.sell, (unsigned long long)echo.bad);
+        print_latency("rtt_us", echo.rtt_ns);
+        print_latency("src->engine_us", echo.in_ns);
+        print_latency("engine_us", echo.engine_ns);
+        print_latency("engine->ack_us", echo.out_ns);
+    }
+    return 0;
+}
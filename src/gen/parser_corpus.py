@@ -0,0 +1,180 @@
+#!/usr/bin/env python3
+# parser_corpus.py -- build the CSV tick parser corpus checked by flow_imbalance_parsecheck (ctest)
+# Usage: python3 parser_corpus.py [out] [--lines=N]
+#   out        corpus file to write (default parser_corpus.txt next to this script)
+#   --lines=N  datagrams to capture from each feedgen.py run (default 400)
+#
+# The corpus holds:
+#   - datagrams sent by feedgen.py over loopback, single-symbol and --symbols=3, captured as-is
+#     (the price walk drifts below zero, so both signs show up)
+#   - hand-written edge cases: signs, exponents, NaN/inf, missing and extra fields, CRLF and
+#     other terminators, overlong and out-of-range numbers, whitespace
+# Each line is `<input>\t<expected>`, with the input escaped (\\ \t \r \n \0 \xHH). Expected is
+# the ParseError name, or `ok <seq> <src_ts> <price> <size> <src_ts tol> <price tol> [<symbol>]`.
+# Doubles are Python reprs of the correctly rounded value. Each has its own tolerance: `exact`
+# means parse_tick_csv must return exactly that double, `ulp` (digits beyond what it keeps, or a
+# mantissa over 2^53) allows 1 ulp. seq, size and symbol are always compared exactly.
+# The expectations come from the rules documented in src/main/parser/TickParser.h, implemented
+# here independently of the C++ parser.
+import os, re, socket, subprocess, sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+flags = [a for a in sys.argv[1:] if a.startswith('--')]
+args = [a for a in sys.argv[1:] if not a.startswith('--')]
+OUT = args[0] if args else os.path.join(HERE, 'parser_corpus.txt')
+LINES = 400
+for f in flags:
+    if f.startswith('--lines='):
+        LINES = max(1, int(f[8:]))
+
+UINT64_MAX = (1 << 64) - 1
+UINT32_MAX = (1 << 32) - 1
+MAX_DIGITS = 19  # kMaxDigits in TickParser.cpp
+DECIMAL = re.compile(rb'[+-]?([0-9]*)(?:\.([0-9]*))?')
+
+
+def capture(extra):
+    """Run feedgen.py against a local socket and return the first LINES datagrams it sends."""
+    rx = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    rx.bind(('127.0.0.1', 0))
+    rx.settimeout(5.0)
+    port = rx.getsockname()[1]
+    gen = subprocess.Popen([sys.executable, os.path.join(HERE, 'feedgen.py'), '127.0.0.1', str(port), '5000'] + extra,
+                           stdout=subprocess.DEVNULL)
+    try:
+        return [rx.recv(2048) for _ in range(LINES)]
+    finally:
+        gen.kill()
+        gen.wait()
+        rx.close()
+
+
+def edge_cases():
+    ok = b'1,1760600000.5,100.25,10'
+    cases = [
+        # signs
+        b'1,1.5,-100.25,10', b'1,1.5,+100.25,10', b'1,-1.5,100.25,10', b'1,1.5,-0.0,10', b'1,1.5,-0,10',
+        b'-1,1.5,100.25,10', b'+1,1.5,100.25,10', b'1,1.5,100.25,-10', b'1,1.5,100.25,+10',
+        b'1,1.5,--100.25,10', b'1,1.5,+-100.25,10', b'1,1.5,-,10', b'1,1.5,+,10',
+        # exponents, NaN/inf, other notations
+        b'1,1.5,1e2,10', b'1,1.5,1E2,10', b'1,1.5,1.5e+2,10', b'1,1.76e9,100.25,10', b'1,1.5,100.25,1e3',
+        b'1,1.5,nan,10', b'1,1.5,NaN,10', b'1,1.5,inf,10', b'1,1.5,-inf,10', b'1,infinity,100.25,10',
+        b'1,1.5,0x10,10', b'0x10,1.5,100.25,10', b'1,1.5,100.25,0x10', b'1,1.5,1_000.0,10',
+        # decimal shapes
+        b'1,1.5,100.,10', b'1,1.5,.25,10', b'1,1.5,-.25,10', b'1,1.5,.,10', b'1,1.5,1..5,10', b'1,1.5,1.5.5,10',
+        b'1,0,0,0', b'0,0.0,0.000000,0', b'1,1.5,100.25,0',
+        # missing, empty and extra fields
+        b'', b'\n', b'\r\n', b' ', b'\0', b'1', b'1,1.5', b'1,1.5,100.25', b'1,1.5,100.25,10,SYM0,extra',
+        b'1,1.5,100.25,10,,', b',1.5,100.25,10', b'1,,100.25,10', b'1,1.5,,10', b'1,1.5,100.25,',
+        b'1,1.5,100.25,10,', b',,,', b',,,,', b'1,1.5,100.25,10,SYM0,', b',,,,,,,,,,,,,,,,,,,,,',
+        # symbols
+        b'1,1.5,100.25,10,SYM0', b'1,1.5,100.25,10,-', b'1,1.5,100.25,10,A B', b'1,1.5,100.25,10, ',
+        b'1,1.5,100.25,10,' + b'X' * 40,
+        # terminators and padding
+        ok + b'\n', ok + b'\r\n', ok + b'\r', ok + b'\n\r', ok + b'\r\n\r\n', ok + b'\0', ok + b'\n\0\0',
+        ok + b'  ', ok + b',SYM0\r\n', ok + b',SYM0 \r\n', ok + b'\t', b'\r\n' + ok, ok + b'\n1,2,3,4',
+        # whitespace inside fields
+        b' 1,1.5,100.25,10', b'1, 1.5,100.25,10', b'1,1.5 ,100.25,10', b'1,1.5,100.25, 10', b'1 ,1.5,100.25,10',
+        # integer range
+        b'18446744073709551615,1.5,100.25,10', b'18446744073709551616,1.5,100.25,10',
+        b'99999999999999999999,1.5,100.25,10', b'000000000000000000000000001,1.5,100.25,10',
+        b'1,1.5,100.25,4294967295', b'1,1.5,100.25,4294967296', b'1,1.5,100.25,00000000000000000004294967295',
+        # overlong decimals
+        b'1,1760600000.123456789,100.25,10', b'1,1760600000123.456789,100.25,10',
+        b'1,1.5,0.1234567890123456789012345,10', b'1,1.5,123456789012345.6,10', b'1,1.5,1234567890123456.7,10',
+        b'1,1.5,9007199254740993,10', b'1,1.5,9007199254740993.0,10', b'1,1.5,1234567890123456789,10',
+        b'1,1.5,1234567890123456789.5,10', b'1,1.5,12345678901234567890,10', b'1,1.5,0000000000000000000.5,10',
+        b'1,1.5,00000000000000000000.5,10', b'1,1.5,0.000000000000000000001,10', b'1,1.5,999999999999999.9,10',
+        b'1,1.5,0.00001234567890123456789,10', b'1,1.5,-0.000000000000000000000000000000123,10',
+        b'1,1.5,0.00000000000000000000000000000000000000,10', b'1,1.5,1.00000000000000000000000000001,10',
+        b'1,1.5,0.1,10', b'1,1.5,0.3,10', b'1,1.5,2.675,10', b'1,1.5,1.0000000000000002,10',
+        # long lines put commas past the first 16-byte SIMD block
+        b'123456789012345678,1760600000.123456789,12345.678901,4000000000,SYMBOL_WITH_A_LONG_NAME',
+        b'1234567890123456789,1.5,100.25,10', b'1,1.500000000000000000,100.250000000000000,10',
+    ]
+    return cases
+
+
+def parse_uint(text, max_val):
+    if not text or not text.isdigit():
+        return None
+    v = int(text)
+    return v if v <= max_val else None
+
+
+def parse_decimal(text):
+    """(value, exact) per parse_decimal in TickParser.cpp, or None if rejected."""
+    m = DECIMAL.fullmatch(text)
+    if not m:
+        return None
+    ip, fp = m.group(1), m.group(2) or b''
+    if not ip and not fp:
+        return None
+    if len(ip) > MAX_DIGITS:
+        return None
+    value = float(text.decode())
+    # fraction digits are taken while fewer than 19 significant digits (leading zeros excluded) are in
+    ipv = int(ip or b'0')
+    sig = len(ip.lstrip(b'0'))
+    fpv = kept = 0
+    for d in fp:
+        if sig >= MAX_DIGITS:
+            break
+        fpv = fpv * 10 + d - 0x30
+        kept += 1
+        if ipv or fpv:
+            sig += 1
+    if fp[kept:].strip(b'0'):
+        return value, False  # significant digits past the 19th are dropped
+    if kept == 0 or kept > 22:
+        return value, True   # double(ip), or the library fallback: one correct rounding
+    # one exact division when the combined mantissa fits 53 bits, otherwise two roundings
+    return value, (ipv * 10 ** kept + fpv) <= (1 << 53)
+
+
+def expect(raw):
+    s = raw.rstrip(b'\n\r \0')
+    if not s:
+        return 'Empty'
+    fields = s.split(b',')
+    if len(fields) not in (4, 5):
+        return 'Fields'
+    if len(fields) == 5 and not fields[4]:
+        return 'BadSymbol'
+    seq = parse_uint(fields[0], UINT64_MAX)
+    if seq is None:
+        return 'BadSeq'
+    src_ts = parse_decimal(fields[1])
+    if src_ts is None:
+        return 'BadSrcTs'
+    price = parse_decimal(fields[2])
+    if price is None:
+        return 'BadPrice'
+    size = parse_uint(fields[3], UINT32_MAX)
+    if size is None:
+        return 'BadSize'
+    tol = lambda d: 'exact' if d[1] else 'ulp'
+    out = f'ok {seq} {src_ts[0]!r} {price[0]!r} {size} {tol(src_ts)} {tol(price)}'
+    if len(fields) == 5:
+        out += ' ' + escape(fields[4], space=True)
+    return out
+
+
+def escape(b, space=False):
+    out = []
+    for c in b:
+        if c == 0x5C: out.append('\\\\')
+        elif c == 0x09: out.append('\\t')
+        elif c == 0x0D: out.append('\\r')
+        elif c == 0x0A: out.append('\\n')
+        elif c == 0x00: out.append('\\0')
+        elif c < 0x20 or c >= 0x7F or (space and c == 0x20): out.append(f'\\x{c:02x}')
+        else: out.append(chr(c))
+    return ''.join(out)
+
+
+inputs = capture([]) + capture(['--symbols=3']) + edge_cases()
+with open(OUT, 'w') as f:
+    for raw in inputs:
+        f.write(f'{escape(raw)}\t{expect(raw)}\n')
+print(f'{len(inputs)} cases -> {OUT}')
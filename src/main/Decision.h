@@ -0,0 +1,19 @@
+#pragma once
+#include <cstdint>
+
+// A BUY/SELL signal. Fixed-size and trivially copyable: it is passed through
+// rings by value and written verbatim to binary signal logs (see log/SignalLog.h).
+struct Decision {
+    uint64_t seq;
+    uint32_t symbol;              // dense id from SymbolTable
+    int32_t action;               // 1=BUY, -1=SELL
+    double ewma;
+    double ofi;
+    double src_ts;                // seconds since epoch, from the feed
+    double recv_ts;               // seconds since epoch, at receive
+    int64_t recv_to_decision_ns;  // predictor latency
+    int32_t bank_vote;            // --bank ensemble: configs saying BUY minus configs saying SELL
+    uint32_t bank_configs;        // configs in the bank, 0 without --bank
+};
+
+static_assert(sizeof(Decision) == 64, "Decision is a binary log record; keep its layout stable");
@@ -0,0 +1,172 @@
+#include "Engine.h"
+
+#include "predictor/Predictor.h"
+#include "stats/TscClock.h"
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+Engine::Engine(const EngineConfig& cfg)
+    : symbols_(cfg.max_symbols),
+      store_(cfg.max_symbols, cfg.alpha, cfg.threshold, cfg.tick_size, cfg.book_depth, cfg.ofi_levels),
+      report_os_(&std::cout),
+      report_prefix_(cfg.report_prefix),
+      report_interval_ns_(int64_t(cfg.report_interval_s * 1e9)) {
+    store_.set_predictor(cfg.predictor);
+    store_.set_stage_stats(&stats_.stages);
+    if (cfg.features || !cfg.feature_weights.empty()) {
+        features_.reset(new FeatureEngine(cfg.feature_cfg, cfg.max_symbols));
+        if (!cfg.feature_weights.empty()) {
+            feature_w_.assign(features_->size(), 0.0);
+            for (const auto& [name, w] : cfg.feature_weights) {
+                int i = features_->index(name);
+                if (i >= 0) feature_w_[size_t(i)] += w;
+            }
+        }
+    }
+    if (!cfg.bank.empty()) {
+        bank_.reset(new PredictorBank(cfg.bank, cfg.max_symbols));
+        bank_configs_ = uint32_t(bank_->size());
+    }
+}
+
+void Engine::prepare_symbols() {
+    for (; prepared_ < symbols_.size(); ++prepared_) {
+        store_.reserve(uint32_t(prepared_));
+        if (features_) features_->reserve(uint32_t(prepared_));
+    }
+}
+
+void print_histogram(std::ostream& os, const char* prefix, const char* name, const LatencyHistogram& h) {
+    // formatted into one buffer so concurrent writers cannot split the line
+    char line[256];
+    int n = std::snprintf(line, sizeof(line),
+                          "%s %s count=%llu p50=%.2f p90=%.2f p99=%.2f p99.9=%.2f max=%.2f mean=%.2f",
+                          prefix, name, (unsigned long long)h.count(),
+                          h.percentile(0.5) / 1e3, h.percentile(0.9) / 1e3, h.percentile(0.99) / 1e3,
+                          h.percentile(0.999) / 1e3, h.max() / 1e3, h.mean() / 1e3);
+    if (n <= 0) return;
+    std::string out(line, size_t(n) < sizeof(line) ? size_t(n) : sizeof(line) - 1);
+    if (h.negative() != 0) out += " negative=" + std::to_string(h.negative());
+    out += '\n';
+    os.write(out.data(), std::streamsize(out.size()));
+}
+
+namespace {
+
+MetricsPercentiles metrics_percentiles(const LatencyHistogram& h) {
+    static constexpr double Q[] = {0.5, 0.9, 0.99, 0.999};
+    uint64_t v[4];
+    h.percentiles(Q, v, 4);
+    return MetricsPercentiles{h.count(), v[0], v[1], v[2], v[3], h.max()};
+}
+
+} // namespace
+
+void Engine::publish_metrics(const Tick& tick, int action, double ofi, int64_t now_ns) {
+    MetricsSlot& m = *metrics_;
+    metric_add(m.ticks);
+    if (action > 0) metric_add(m.buy);
+    else if (action < 0) metric_add(m.sell);
+    m.last_tick.write(MetricsTick{tick.seq, tick.symbol, action, store_.ewma(tick.symbol), ofi, tick.src_ts, tick.recv_ts,
+                                  bank_vote_, bank_configs_});
+    if (now_ns < next_metrics_ns_) return;
+    // two single-pass bucket scans, a few us every interval
+    m.latency.write(MetricsLatency{
+        metrics_percentiles(stats_.recv_decision_ns), metrics_percentiles(stats_.src_recv_ns),
+        std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count()});
+    next_metrics_ns_ = now_ns + MetricsSlot::LATENCY_INTERVAL_NS;
+}
+
+void Engine::report_interval(int64_t now_ns) {
+    if (next_report_ns_ == 0) {
+        next_report_ns_ = now_ns + report_interval_ns_;
+        return;
+    }
+    print_histogram(*report_os_, report_prefix_.c_str(), "recv->decision_us", stats_.interval_recv_decision_ns);
+    print_histogram(*report_os_, report_prefix_.c_str(), "src->recv_us", stats_.interval_src_recv_ns);
+    report_os_->flush();
+    stats_.interval_recv_decision_ns.reset();
+    stats_.interval_src_recv_ns.reset();
+    next_report_ns_ = now_ns + report_interval_ns_;
+}
+
+bool Engine::process(const Tick& tick, Decision& d) {
+    STAGE_PROBE(&stats_.stages, Stage::Engine);
+    const uint32_t sym = tick.symbol;
+
+    // OFI against this symbol's previous tick; updates its book. A price the book cannot
+    // index is counted there and the tick goes no further, like a parse error
+    double ofi;
+    if (!store_.apply_tick(sym, tick, ofi)) return false;
+
+    double sample = ofi;
+    if (features_) {
+        STAGE_PROBE(&stats_.stages, Stage::Features);
+        const uint64_t f_start = TscClock::now();
+        last_features_ = features_->update(sym, ofi, tick.recv_ts);
+        if (!feature_w_.empty()) sample = Predictor::feature_sample(last_features_, feature_w_.data(), feature_w_.size());
+        stats_.feature_update_ns.record_signed(TscClock::to_ns(int64_t(TscClock::now() - f_start)));
+    }
+
+    // predictor timing
+    int action;
+    uint64_t dec_start, dec_end;
+    {
+        STAGE_PROBE(&stats_.stages, Stage::Predictor);
+        dec_start = TscClock::now();
+        action = store_.process_sample(sym, sample);
+        dec_end = TscClock::now();
+    }
+
+    int64_t recv_to_decision_ns = TscClock::to_ns(int64_t(dec_end - dec_start));
+    int64_t src_to_recv_ns = int64_t((tick.recv_ts - tick.src_ts) * 1e9);
+
+    stats_.push(recv_to_decision_ns, src_to_recv_ns);
+
+    if (bank_) {
+        STAGE_PROBE(&stats_.stages, Stage::Bank);
+        // same input as the main predictor, so the configs are compared on what it trades on
+        bank_vote_ = bank_->update(sym, sample);
+        stats_.bank_update_ns.record_signed(TscClock::to_ns(int64_t(TscClock::now() - dec_end)));
+    }
+    {
+        STAGE_PROBE(&stats_.stages, Stage::Publish);
+        const int64_t now_ns = TscClock::to_ns(int64_t(dec_end));
+        if (report_interval_ns_ > 0 && now_ns >= next_report_ns_) report_interval(now_ns);
+        if (metrics_) publish_metrics(tick, action, ofi, now_ns);
+        if (tick_store_) {
+            const StoreTick st{tick.seq, tick.src_ts, tick.recv_ts, tick.price, ofi, store_.ewma(sym),
+                               tick.size, sym, int8_t(action), bank_vote_};
+            if (tick_store_wait_) tick_store_->record_wait(st);
+            else tick_store_->record(st);
+        }
+    }
+
+    if (action == 0) return false;
+    d.seq = tick.seq;
+    d.symbol = sym;
+    d.action = action;
+    d.ewma = store_.ewma(sym);
+    d.ofi = ofi;
+    d.src_ts = tick.src_ts;
+    d.recv_ts = tick.recv_ts;
+    d.recv_to_decision_ns = recv_to_decision_ns;
+    d.bank_vote = bank_vote_;
+    d.bank_configs = bank_configs_;
+    return true;
+}
+
+bool Engine::deliver(const Tick& tick) {
+    const bool signal = process(tick, out_);
+    STAGE_PROBE(&stats_.stages, Stage::Output);
+    if (echo_) echo_->on_tick(tick, signal ? out_.action : 0);
+    if (!signal) return false;
+    ++decisions_;
+    if (log_) {
+        if (log_wait_) log_->log_wait(out_);
+        else log_->log(out_);
+    }
+    return true;
+}
@@ -0,0 +1,209 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "Decision.h"
+#include "OrderBook.h"
+#include "SymbolStore.h"
+#include "SymbolTable.h"
+#include "features/FeatureEngine.h"
+#include "ingest/Echo.h"
+#include "log/SignalLog.h"
+#include "metrics/SharedMetrics.h"
+#include "parser/TickParser.h"
+#include "predictor/PredictorBank.h"
+#include "stats/LatencyHistogram.h"
+#include "stats/StageProbe.h"
+#include "store/TickStore.h"
+
+/*
+ The tick path, independent of where datagrams come from or which thread runs it:
+   decode()  datagram -> Tick(s): format detection, parsing, symbol interning
+   process() Tick -> OFI / book / EWMA decision, latency stats
+ Decisions are handed to a SignalLog (log/SignalLog.h), which formats or
+ stores them off the hot thread; with a TickStore (store/TickStore.h) every
+ tick's OFI / EWMA / action is also kept, HOLD included. decode() and
+ process() only share state through the Tick they exchange, so they can run
+ inline on one thread or on separate pipeline threads connected by a ring. The
+ one exception: decode() allocates a newly interned symbol's per-symbol storage
+ (book ladders, feature ring) before handing out its first tick, and process()
+ only touches a symbol after that tick has crossed the ring, so the allocation
+ never lands on the tick path.
+*/
+
+// latency histograms in nanoseconds: cumulative for the run, plus the current report interval
+struct Stats {
+    LatencyHistogram recv_decision_ns;
+    LatencyHistogram src_recv_ns;
+    LatencyHistogram interval_recv_decision_ns;
+    LatencyHistogram interval_src_recv_ns;
+    // PredictorBank::update per tick, only recorded when a bank is configured
+    LatencyHistogram bank_update_ns;
+    // FeatureEngine::update per tick, only recorded with features on
+    LatencyHistogram feature_update_ns;
+    // per-stage self time in TscClock ticks; empty unless built with FLOW_IMBALANCE_STAGE_PROBES
+    StageStats stages;
+    void push(int64_t recv_decision, int64_t src_recv) {
+        recv_decision_ns.record_signed(recv_decision);
+        src_recv_ns.record_signed(src_recv);
+        interval_recv_decision_ns.record_signed(recv_decision);
+        interval_src_recv_ns.record_signed(src_recv);
+    }
+};
+
+// one line: `<prefix> <name> count=.. p50=.. p90=.. p99=.. p99.9=.. max=.. mean=..` in microseconds
+void print_histogram(std::ostream& os, const char* prefix, const char* name, const LatencyHistogram& h);
+
+struct EngineConfig {
+    double alpha = 0.15;
+    double threshold = 40.0;
+    size_t max_symbols = 4096;
+    double tick_size = 0.01;
+    size_t book_depth = 1024;
+    size_t ofi_levels = 1;
+    // seconds between INTERVAL latency lines; 0 disables them
+    double report_interval_s = 10.0;
+    // first word(s) of those lines, e.g. to tell shards apart
+    std::string report_prefix = "INTERVAL";
+    // Runtime: Predictor::step with alpha/threshold above; static kinds use the
+    // compile-time ENGINE_ALPHA / ENGINE_THRESHOLD (predictor/StaticPredictor.h)
+    PredictorKind predictor = PredictorKind::Runtime;
+    // per-tick multi-horizon OFI features (features/FeatureEngine.h)
+    bool features = false;
+    FeatureConfig feature_cfg;
+    // non-empty: the predictor consumes sum(weight * feature) instead of the raw OFI.
+    // names must exist in the feature layout (check with FeatureEngine::index)
+    std::vector<std::pair<std::string, double>> feature_weights;
+    // optional bank of extra alpha/threshold pairs stepped on every tick (empty = off)
+    std::vector<BankConfig> bank;
+};
+
+class Engine {
+public:
+    explicit Engine(const EngineConfig& cfg);
+
+    // decode one datagram; calls sink(const Tick&) for every valid tick it carries
+    template <typename Sink>
+    void decode(const char* buf, size_t len, double recv_ts, Sink&& sink);
+
+    // run one tick through OFI, book and predictor; returns true and fills `d` on a BUY/SELL
+    bool process(const Tick& tick, Decision& d);
+    // process() plus the output stage: echo ack, then a BUY/SELL to the signal log and the
+    // decision count. The tick handler of every receive path (inline, pipeline, shard)
+    bool deliver(const Tick& tick);
+    // ticks were lost before the next process(): drop per-symbol state that assumes consecutive ticks
+    void resync() { store_.resync(); }
+
+    // publish per-tick counters, the last tick and (every MetricsSlot::LATENCY_INTERVAL_NS)
+    // latency percentiles to a shared-memory slot from the thread calling process(); null = off
+    void set_metrics(MetricsSlot* m) { metrics_ = m; }
+
+    // copy every processed tick into `s` from the thread calling process(); `wait` blocks on
+    // a full ring instead of dropping (replay). null = off
+    void set_tick_store(TickStore* s, bool wait) {
+        tick_store_ = s;
+        tick_store_wait_ = wait;
+    }
+
+    // where deliver() sends decisions and acks, from the thread calling it; `wait` blocks on a
+    // full log ring instead of dropping (replay). null = off
+    void set_output(SignalLog* log, EchoSender* echo, bool wait) {
+        log_ = log;
+        echo_ = echo;
+        log_wait_ = wait;
+    }
+
+    // where INTERVAL latency lines go (default std::cout); written from the thread calling process()
+    void set_report_stream(std::ostream* os) { report_os_ = os; }
+
+    const Stats& stats() const { return stats_; }
+    // BUY/SELL decisions deliver() has emitted
+    uint64_t decisions() const { return decisions_; }
+    // for probes around work done outside the engine (output); see stats/StageProbe.h
+    StageStats* stage_stats() { return &stats_.stages; }
+    const ParseCounters& parse_counters() const { return parser_.counters(); }
+    const SymbolTable& symbols() const { return symbols_; }
+    const SymbolStore& store() const { return store_; }
+    // null without EngineConfig::bank; masks reflect the last processed tick
+    const PredictorBank* bank() const { return bank_.get(); }
+    // bank ensemble vote of the last processed tick (BUY configs - SELL configs); it also goes
+    // into every Decision, the tick store's bank_vote column and the metrics' last tick
+    int bank_vote() const { return bank_vote_; }
+    // null without EngineConfig::features
+    const FeatureEngine* features() const { return features_.get(); }
+    // feature vector of the last processed tick (features()->size() values), null without features
+    const double* last_features() const { return last_features_; }
+
+private:
+    TickParser parser_;
+    // per-symbol previous tick, book and EWMA state, indexed by interned symbol id
+    SymbolTable symbols_;
+    SymbolStore store_;
+    std::unique_ptr<PredictorBank> bank_;
+    int bank_vote_ = 0;
+    uint32_t bank_configs_ = 0;
+    std::unique_ptr<FeatureEngine> features_;
+    std::vector<double> feature_w_;  // dense weights, empty = predictor takes raw OFI
+    const double* last_features_ = nullptr;
+    Stats stats_;
+    MetricsSlot* metrics_ = nullptr;
+    int64_t next_metrics_ns_ = 0;
+    void publish_metrics(const Tick& tick, int action, double ofi, int64_t now_ns);
+    TickStore* tick_store_ = nullptr;
+    bool tick_store_wait_ = false;
+    SignalLog* log_ = nullptr;
+    EchoSender* echo_ = nullptr;
+    bool log_wait_ = false;
+    Decision out_;
+    uint64_t decisions_ = 0;
+
+    // symbol ids below this have their storage allocated; decode() side only
+    size_t prepared_ = 0;
+    void prepare_symbols();
+
+    std::ostream* report_os_;
+    std::string report_prefix_;
+    int64_t report_interval_ns_;
+    int64_t next_report_ns_ = 0;
+    void report_interval(int64_t now_ns);
+};
+
+template <typename Sink>
+void Engine::decode(const char* buf, size_t len, double recv_ts, Sink&& sink) {
+    // format is detected from the first byte: binary magic or CSV text
+    if (is_binary_tick(buf, len)) {
+        int cnt = parser_.binary_count(buf, len);
+        for (int r = 0; r < cnt; ++r) {
+            Tick tick;
+            {
+                STAGE_PROBE(&stats_.stages, Stage::Parse);
+                decode_binary_tick(buf, r, tick);
+                tick.symbol = symbols_.intern_wire(tick.symbol);
+            }
+            if (tick.symbol == SymbolTable::INVALID) continue;
+            if (tick.symbol >= prepared_) prepare_symbols();
+            tick.recv_ts = recv_ts;
+            sink(tick);
+        }
+    } else {
+        // parse CSV: seq,src_ts,price,size[,symbol] (malformed lines are counted by the parser)
+        Tick tick{};
+        {
+            STAGE_PROBE(&stats_.stages, Stage::Parse);
+            std::string_view sym_name;
+            if (!parser_.parse(buf, len, tick, sym_name)) return;
+            // lines without a symbol field belong to a single default instrument
+            tick.symbol = symbols_.intern(sym_name.empty() ? std::string_view("-") : sym_name);
+        }
+        if (tick.symbol == SymbolTable::INVALID) return;
+        if (tick.symbol >= prepared_) prepare_symbols();
+        tick.recv_ts = recv_ts;
+        sink(tick);
+    }
+}
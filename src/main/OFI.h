@@ -1,11 +1,43 @@
 #pragma once
+#include <cstddef>
+
 #include "OrderBook.h"
 
-// Very small OFI helper, compute OFI-like score from two consecutive ticks.
-// OFI approximation used here: sign(price_delta) * size
+// Trade-only fallback for feeds without quotes (e.g. CSV): sign(price_delta) * size
+// between two consecutive trades of the same instrument.
 inline double compute_ofi(const Tick& prev, const Tick& cur) {
     double dp = cur.price - prev.price;
     if (dp > 0) return double(cur.size);
     if (dp < 0) return -double(cur.size);
     return 0.0;
 }
+
+// Order flow imbalance of one price level between two book states
+// (Cont, Kukanov & Stoikov 2014):
+//   e = 1{b >= b'} q_b - 1{b <= b'} q_b' - 1{a <= a'} q_a + 1{a >= a'} q_a'
+// where primed values are the previous state. Empty sides use -inf/+inf prices
+// with size 0, which makes a level appearing or vanishing count as a full add/cancel.
+inline double level_ofi(const BookLevel& pb, const BookLevel& pa, const BookLevel& cb, const BookLevel& ca) {
+    double e = 0.0;
+    if (cb.price >= pb.price) e += double(cb.size);
+    if (cb.price <= pb.price) e -= double(pb.size);
+    if (ca.price <= pa.price) e -= double(ca.size);
+    if (ca.price >= pa.price) e += double(pa.size);
+    return e;
+}
+
+// OFI from the best bid/ask transition
+inline double compute_ofi(const BookTop& prev, const BookTop& cur) {
+    return level_ofi(prev.bid, prev.ask, cur.bid, cur.ask);
+}
+
+// Multi-level OFI: sum of level_ofi over the top `levels` levels of each side
+// (arrays as filled by OrderBook::depth), equally weighted.
+inline double compute_mlofi(const BookLevel* prev_bids, const BookLevel* prev_asks,
+                            const BookLevel* cur_bids, const BookLevel* cur_asks, size_t levels) {
+    double e = 0.0;
+    for (size_t m = 0; m < levels; ++m) {
+        e += level_ofi(prev_bids[m], prev_asks[m], cur_bids[m], cur_asks[m]);
+    }
+    return e;
+}
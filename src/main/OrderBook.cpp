@@ -1,15 +1,172 @@
 #include "OrderBook.h"
 
-OrderBook::OrderBook() : last_price_(0.0), last_size_(0), has_last_(false) {}
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
-void OrderBook::apply_tick(const Tick& t) {
-    last_price_ = t.price;
-    last_size_ = t.size;
-    has_last_ = true;
+namespace {
+constexpr double kInf = std::numeric_limits<double>::infinity();
+}
+
+OrderBook::OrderBook(double tick_size, size_t depth)
+    : last_price_(0.0), prev_price_(0.0), last_size_(0), has_last_(false), has_prev_(false),
+      tick_size_(tick_size > 0.0 ? tick_size : 0.01),
+      inv_tick_(1.0 / tick_size_),
+      cap_(depth < 16 ? 16 : depth) {}
+
+void OrderBook::reserve() {
+    if (!bid_.empty()) return;
+    bid_.assign(cap_, 0);
+    ask_.assign(cap_, 0);
+}
+
+void OrderBook::clear() {
+    std::fill(bid_.begin(), bid_.end(), 0u);
+    std::fill(ask_.begin(), ask_.end(), 0u);
+    best_bid_ = NONE;
+    best_ask_ = NONE;
+    anchored_ = false;
+    has_last_ = false;
+    has_prev_ = false;
+}
+
+bool OrderBook::apply_tick(const Tick& t) {
+    if (!accepts(t.price)) {
+        ++bad_price_;
+        return false;
+    }
+    if (t.type == TickType::Trade) {
+        prev_price_ = last_price_;
+        has_prev_ = has_last_;
+        last_price_ = t.price;
+        last_size_ = t.size;
+        has_last_ = true;
+        return true;
+    }
+    if (t.side != 1 && t.side != -1) return true;
+    int64_t idx = to_index(t.price);
+    if (!ensure_window(idx)) return true;
+    uint32_t size = t.type == TickType::Delete ? 0 : t.size;
+    set_level(t.side, idx, size);
+    return true;
+}
+
+// only called on prices accepts() passed, so the result fits comfortably in int64
+int64_t OrderBook::to_index(double price) const {
+    return int64_t(std::llround(price * inv_tick_));
+}
+
+// make sure `idx` maps into the ladder; recentre on the touch if needed.
+// returns false if the level is too far from the touch to track.
+bool OrderBook::ensure_window(int64_t idx) {
+    const int64_t half = int64_t(cap_ / 2);
+    if (!anchored_) {
+        // first book update for this instrument; allocates only if reserve() was never called
+        reserve();
+        base_ = idx - half;
+        anchored_ = true;
+        return true;
+    }
+    if (idx >= base_ && idx < base_ + int64_t(cap_)) return true;
+
+    int64_t ref = best_bid_ != NONE ? best_bid_ : (best_ask_ != NONE ? best_ask_ : idx);
+    if (best_bid_ != NONE && best_ask_ != NONE) ref = best_bid_ + (best_ask_ - best_bid_) / 2;
+    if (idx - ref >= half || ref - idx >= half) {
+        ++out_of_range_;
+        return false;
+    }
+
+    // shift both ladders so `ref` sits in the middle; levels falling off the edge are dropped
+    int64_t new_base = ref - half;
+    int64_t shift = new_base - base_;
+    auto move = [&](std::vector<uint32_t>& v) {
+        if (shift > 0) {
+            size_t s = size_t(std::min<int64_t>(shift, int64_t(cap_)));
+            std::move(v.begin() + s, v.end(), v.begin());
+            std::fill(v.end() - s, v.end(), 0u);
+        } else {
+            size_t s = size_t(std::min<int64_t>(-shift, int64_t(cap_)));
+            std::move_backward(v.begin(), v.end() - s, v.end());
+            std::fill(v.begin(), v.begin() + s, 0u);
+        }
+    };
+    move(bid_);
+    move(ask_);
+    base_ = new_base;
+    ++recenters_;
+
+    // a best level can only fall off the window if the book is crossed by more than
+    // depth/2 ticks; recover by rescanning what is left
+    auto outside = [&](int64_t b) { return b != NONE && (b < base_ || b >= base_ + int64_t(cap_)); };
+    if (outside(best_bid_)) {
+        best_bid_ = NONE;
+        for (size_t s = cap_; s-- > 0;) {
+            if (bid_[s] != 0) { best_bid_ = base_ + int64_t(s); break; }
+        }
+    }
+    if (outside(best_ask_)) {
+        best_ask_ = NONE;
+        for (size_t s = 0; s < cap_; ++s) {
+            if (ask_[s] != 0) { best_ask_ = base_ + int64_t(s); break; }
+        }
+    }
+    return true;
+}
+
+void OrderBook::set_level(int side, int64_t idx, uint32_t size) {
+    const size_t slot = size_t(idx - base_);
+    if (side == 1) {
+        bid_[slot] = size;
+        if (size != 0) {
+            if (best_bid_ == NONE || idx > best_bid_) best_bid_ = idx;
+        } else if (idx == best_bid_) {
+            // best bid removed: walk down to the next live level
+            best_bid_ = NONE;
+            for (size_t s = slot; s-- > 0;) {
+                if (bid_[s] != 0) { best_bid_ = base_ + int64_t(s); break; }
+            }
+        }
+    } else {
+        ask_[slot] = size;
+        if (size != 0) {
+            if (best_ask_ == NONE || idx < best_ask_) best_ask_ = idx;
+        } else if (idx == best_ask_) {
+            best_ask_ = NONE;
+            for (size_t s = slot + 1; s < cap_; ++s) {
+                if (ask_[s] != 0) { best_ask_ = base_ + int64_t(s); break; }
+            }
+        }
+    }
+}
+
+BookLevel OrderBook::best_bid() const {
+    if (best_bid_ == NONE) return {-kInf, 0};
+    return {to_price(best_bid_), bid_[size_t(best_bid_ - base_)]};
+}
+
+BookLevel OrderBook::best_ask() const {
+    if (best_ask_ == NONE) return {kInf, 0};
+    return {to_price(best_ask_), ask_[size_t(best_ask_ - base_)]};
+}
+
+size_t OrderBook::depth(int side, size_t n, BookLevel* out) const {
+    size_t got = 0;
+    if (side == 1 && best_bid_ != NONE) {
+        for (size_t s = size_t(best_bid_ - base_) + 1; s-- > 0 && got < n;) {
+            if (bid_[s] != 0) out[got++] = {to_price(base_ + int64_t(s)), bid_[s]};
+        }
+    } else if (side == -1 && best_ask_ != NONE) {
+        for (size_t s = size_t(best_ask_ - base_); s < cap_ && got < n; ++s) {
+            if (ask_[s] != 0) out[got++] = {to_price(base_ + int64_t(s)), ask_[s]};
+        }
+    }
+    const BookLevel empty = side == 1 ? BookLevel{-kInf, 0} : BookLevel{kInf, 0};
+    for (size_t i = got; i < n; ++i) out[i] = empty;
+    return got;
 }
 
 double OrderBook::last_price_delta() const {
-    return has_last_ ? (last_price_ - last_price_) : 0.0; // trivial placeholder
+    return has_prev_ ? (last_price_ - prev_price_) : 0.0;
 }
 
 double OrderBook::last_price() const { return last_price_; }
@@ -1,33 +1,119 @@
 #pragma once
+#include <cstddef>
 #include <cstdint>
 #include <optional>
+#include <vector>
 
 /*
- Simple L1-ish state to keep last price and last size.
- This is intentionally minimal for now
+ Price-level (L2) order book plus last-trade state.
+ - bid and ask sizes live in two contiguous ladders indexed by price / tick_size,
+   covering a window of `depth` ticks that is recentred on the touch when
+   quotes drift outside it
+ - best bid/ask indices are tracked incrementally; add/modify at or inside the
+   touch is O(1), deleting the best level scans outward to the next live level
+ - ladders are allocated by reserve(), which Engine::decode calls when the
+   symbol is interned, so no tick pays for it; a book that was never
+   reserved allocates them on its first update instead (a one-time cost of
+   two depth-sized vectors). After that updates never allocate
+ - trade ticks only update last price/size
+ - clear() starts the book over (after lost updates) without freeing the ladders
+ - prices that are NaN/inf or too large to index (|price / tick_size| >= 2^52)
+   are rejected and counted, for trades as well as book updates
 */
 
+enum class TickType : uint8_t {
+    Trade = 0,  // last-sale print: price/size/aggressor side
+    Add,        // new price level (side 1 = bid, -1 = ask)
+    Modify,     // set the aggregate size of an existing level
+    Delete,     // remove a price level
+};
+
 struct Tick {
     uint64_t seq;
     double src_ts;
     double recv_ts;
     double price;
     uint32_t size;
+    uint32_t symbol; // dense id from SymbolTable
+    int8_t side;     // trades: aggressor 1 = buy, -1 = sell, 0 = unknown (CSV); book updates: 1 = bid, -1 = ask
+    TickType type;   // Trade for CSV feeds
+};
+
+struct BookLevel {
+    double price;    // -inf (bid) / +inf (ask) when the side is empty
+    uint32_t size;
+};
+
+struct BookTop {
+    BookLevel bid;
+    BookLevel ask;
 };
 
 class OrderBook {
 public:
-    OrderBook();
+    explicit OrderBook(double tick_size = 0.01, size_t depth = 1024);
     // ~OrderBook();
 
-    void apply_tick(const Tick& t);
-    // returns price delta (price - last_price) or 0 if no previous
+    // allocate the ladders now rather than on the first book update
+    void reserve();
+    // drop every level and the last-trade state; the ladders stay allocated, counters are kept
+    void clear();
+    // false (and counted in bad_price()) if the price cannot be indexed
+    bool apply_tick(const Tick& t);
+    bool accepts(double price) const {
+        const double x = price * inv_tick_;
+        return x > -MAX_INDEX && x < MAX_INDEX;  // NaN fails both
+    }
+    // returns price delta between the last two trades, or 0 if fewer than two
     double last_price_delta() const;
     double last_price() const;
     uint32_t last_size() const;
     bool has_last() const;
+
+    BookLevel best_bid() const;
+    BookLevel best_ask() const;
+    BookTop top() const { return {best_bid(), best_ask()}; }
+    // a book update has been applied since construction / clear()
+    bool has_quotes() const { return anchored_; }
+    // both sides have a live best level
+    bool has_touch() const { return best_bid_ != NONE && best_ask_ != NONE; }
+    // copy up to `n` best levels of one side (1 = bid, -1 = ask) into `out`,
+    // padding missing levels with the empty-side sentinel; returns live levels copied
+    size_t depth(int side, size_t n, BookLevel* out) const;
+
+    double tick_size() const { return tick_size_; }
+    // updates ignored because they were further than depth/2 ticks from the touch
+    uint64_t out_of_range() const { return out_of_range_; }
+    uint64_t recenters() const { return recenters_; }
+    // ticks rejected for a NaN, infinite or out-of-range price
+    uint64_t bad_price() const { return bad_price_; }
+
 private:
+    static constexpr int64_t NONE = INT64_MIN;
+    // price indices stay exact integers in a double, and far from int64 overflow
+    static constexpr double MAX_INDEX = 4503599627370496.0;  // 2^52
+
     double last_price_;
+    double prev_price_;
     uint32_t last_size_;
     bool has_last_;
+    bool has_prev_;
+
+    double tick_size_;
+    double inv_tick_;
+    size_t cap_;
+    int64_t base_ = 0;            // price index held in ladder slot 0
+    bool anchored_ = false;       // base_ set by the first book update
+    std::vector<uint32_t> bid_;   // size per price level, slot = idx - base_
+    std::vector<uint32_t> ask_;
+    int64_t best_bid_ = NONE;     // absolute price index, NONE if side empty
+    int64_t best_ask_ = NONE;
+    uint64_t out_of_range_ = 0;
+    uint64_t recenters_ = 0;
+    uint64_t bad_price_ = 0;
+
+    int64_t to_index(double price) const;
+    double to_price(int64_t idx) const { return double(idx) * tick_size_; }
+    bool ensure_window(int64_t idx);
+    void set_level(int side, int64_t idx, uint32_t size);
 };
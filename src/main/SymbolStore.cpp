@@ -0,0 +1,82 @@
+#include "SymbolStore.h"
+
+#include <algorithm>
+
+#include "OFI.h"
+
+SymbolStore::SymbolStore(size_t capacity, double alpha, double threshold,
+                         double tick_size, size_t book_depth, size_t ofi_levels)
+    : ofi_levels_(ofi_levels == 0 ? 1 : (ofi_levels > MAX_OFI_LEVELS ? MAX_OFI_LEVELS : ofi_levels)),
+      ewma_(capacity, 0.0),
+      alpha_(capacity, alpha),
+      threshold_(capacity, threshold),
+      have_prev_(capacity, 0),
+      prev_tick_(capacity, Tick{}),
+      ticks_(capacity, 0),
+      book_(capacity, OrderBook(tick_size, book_depth)),
+      rebuilding_(capacity, 0) {}
+
+bool SymbolStore::apply_tick(uint32_t id, const Tick& t, double& ofi) {
+    // everything here but the book update itself is the ofi stage
+    STAGE_PROBE(stages_, Stage::Ofi);
+    OrderBook& book = book_[id];
+    ofi = 0.0;
+    if (t.type == TickType::Trade) {
+        // the book vets the price first, so a bad print never becomes the previous trade
+        {
+            STAGE_PROBE(stages_, Stage::Book);
+            if (!book.apply_tick(t)) return false;
+        }
+        if (have_prev_[id]) ofi = compute_ofi(prev_tick_[id], t);
+        prev_tick_[id] = t;
+        have_prev_[id] = 1;
+    } else if (ofi_levels_ == 1) {
+        BookTop before = book.top();
+        {
+            STAGE_PROBE(stages_, Stage::Book);
+            if (!book.apply_tick(t)) return false;
+        }
+        ofi = compute_ofi(before, book.top());
+    } else {
+        BookLevel pb[MAX_OFI_LEVELS], pa[MAX_OFI_LEVELS], cb[MAX_OFI_LEVELS], ca[MAX_OFI_LEVELS];
+        book.depth(1, ofi_levels_, pb);
+        book.depth(-1, ofi_levels_, pa);
+        {
+            STAGE_PROBE(stages_, Stage::Book);
+            if (!book.apply_tick(t)) return false;
+        }
+        book.depth(1, ofi_levels_, cb);
+        book.depth(-1, ofi_levels_, ca);
+        ofi = compute_mlofi(pb, pa, cb, ca, ofi_levels_);
+    }
+    if (rebuilding_[id] && t.type != TickType::Trade) {
+        // the book restarted empty after a gap: OFI against a missing side is not flow
+        ofi = 0.0;
+        ++rebuild_ticks_;
+        if (book.has_touch()) rebuilding_[id] = 0;
+    }
+    ++ticks_[id];
+    return true;
+}
+
+void SymbolStore::set_predictor(PredictorKind kind) {
+    kind_ = kind;
+    ewma_f_.assign(kind == PredictorKind::StaticFloat ? ewma_.size() : 0, 0.0f);
+    ewma_q_.assign(kind == PredictorKind::StaticFixed ? ewma_.size() : 0, 0);
+}
+
+void SymbolStore::set_params(uint32_t id, double alpha, double threshold) {
+    alpha_[id] = alpha;
+    threshold_[id] = threshold;
+}
+
+void SymbolStore::resync() {
+    std::fill(have_prev_.begin(), have_prev_.end(), uint8_t(0));
+    // the lost ticks may have been any symbol's book updates
+    for (size_t id = 0; id < book_.size(); ++id) {
+        if (!book_[id].has_quotes()) continue;
+        book_[id].clear();
+        rebuilding_[id] = 1;
+        ++book_resets_;
+    }
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "OrderBook.h"
+#include "predictor/Predictor.h"
+#include "predictor/StaticPredictor.h"
+#include "stats/StageProbe.h"
+
+/*
+ Per-instrument engine state, stored structure-of-arrays and indexed by the
+ dense id from SymbolTable.
+ - one column per field (previous tick, book, EWMA, alpha, threshold, ...)
+ - all columns are sized to the table capacity up front, so the per-tick path
+   is an index into contiguous arrays with no allocation or pointer chasing
+ - EWMA/threshold logic is Predictor::step, so single- and multi-symbol
+   runs make identical decisions; set_predictor() switches every symbol to a
+   compile-time StaticPredictor (ENGINE_ALPHA / ENGINE_THRESHOLD, per-symbol
+   params are then ignored) whose state lives in its own column
+ - OFI: quote updates use the best-level (or top-N multi-level) Cont-Kukanov
+   OFI of the symbol's book; trades fall back to the trade-sign proxy
+ - after lost ticks (resync) a book may hold phantom or stale levels at the
+   touch, since a lost Delete or Modify is never repaired by later updates.
+   Every book that has seen quotes is cleared, and its quote OFI is 0 until
+   both sides of the touch are back, so no OFI is taken against a half-built book
+*/
+
+class SymbolStore {
+public:
+    static constexpr size_t MAX_OFI_LEVELS = 10;
+
+    // `ofi_levels` > 1 selects multi-level OFI over that many book levels (capped at MAX_OFI_LEVELS)
+    SymbolStore(size_t capacity, double alpha, double threshold,
+                double tick_size = 0.01, size_t book_depth = 1024, size_t ofi_levels = 1);
+
+    // apply the tick to the symbol's book and set `ofi` to its OFI contribution; false (the
+    // tick is ignored, counted in the book's bad_price()) if its price is NaN/inf or out of range
+    bool apply_tick(uint32_t id, const Tick& t, double& ofi);
+    // allocate the symbol's book ladders ahead of its first quote
+    void reserve(uint32_t id) { book_[id].reserve(); }
+    // EWMA update for the symbol; returns action: 1=BUY, -1=SELL, 0=HOLD.
+    // inline so the selected step folds into the caller's tick loop
+    int process_sample(uint32_t id, double ofi) {
+        // the kind is fixed for the run, so this branch always predicts
+        switch (kind_) {
+            case PredictorKind::StaticDouble: return EngineStaticDouble::step(ewma_[id], ofi);
+            case PredictorKind::StaticFloat: return EngineStaticFloat::step(ewma_f_[id], ofi);
+            case PredictorKind::StaticFixed: return EngineStaticFixed::step(ewma_q_[id], ofi);
+            default: return Predictor::step(ewma_[id], alpha_[id], threshold_[id], ofi);
+        }
+    }
+
+    void set_params(uint32_t id, double alpha, double threshold);
+    // call before the first tick
+    void set_predictor(PredictorKind kind);
+    PredictorKind predictor() const { return kind_; }
+    // after ticks were lost: forget every symbol's previous trade, clear the quote books and
+    // suppress their OFI until the touch is rebuilt; EWMAs are kept
+    void resync();
+    // ofi / book stage probes (stats/StageProbe.h) record here; null = not recorded
+    void set_stage_stats(StageStats* s) { stages_ = s; }
+
+    double ewma(uint32_t id) const {
+        switch (kind_) {
+            case PredictorKind::StaticFloat: return EngineStaticFloat::to_double(ewma_f_[id]);
+            case PredictorKind::StaticFixed: return EngineStaticFixed::to_double(ewma_q_[id]);
+            default: return ewma_[id];
+        }
+    }
+    uint64_t ticks(uint32_t id) const { return ticks_[id]; }
+    const OrderBook& book(uint32_t id) const { return book_[id]; }
+    // books cleared by resync(), and quote ticks whose OFI was zeroed while one was rebuilding
+    uint64_t book_resets() const { return book_resets_; }
+    uint64_t rebuild_ticks() const { return rebuild_ticks_; }
+    size_t capacity() const { return ewma_.size(); }
+
+private:
+    size_t ofi_levels_;
+    PredictorKind kind_ = PredictorKind::Runtime;
+    StageStats* stages_ = nullptr;
+
+    // hot columns first: touched on every tick
+    std::vector<double> ewma_;         // Runtime and StaticDouble
+    std::vector<float> ewma_f_;        // StaticFloat only
+    std::vector<int64_t> ewma_q_;      // StaticFixed only (Q16)
+    std::vector<double> alpha_;
+    std::vector<double> threshold_;
+    std::vector<uint8_t> have_prev_;
+    std::vector<Tick> prev_tick_;
+    std::vector<uint64_t> ticks_;
+    std::vector<OrderBook> book_;
+    std::vector<uint8_t> rebuilding_;  // book cleared by resync(), touch not complete yet
+    uint64_t book_resets_ = 0;
+    uint64_t rebuild_ticks_ = 0;
+};
@@ -0,0 +1,55 @@
+#include "SymbolTable.h"
+
+#include <cstdio>
+
+SymbolTable::SymbolTable(size_t capacity) : capacity_(capacity) {
+    by_name_.reserve(capacity);
+    by_wire_.reserve(capacity);
+    names_.reserve(capacity);
+    last_name_.reserve(64);
+}
+
+uint32_t SymbolTable::add(std::string name) {
+    if (names_.size() >= capacity_) {
+        ++overflow_;
+        return INVALID;
+    }
+    uint32_t id = uint32_t(names_.size());
+    names_.push_back(std::move(name));
+    return id;
+}
+
+uint32_t SymbolTable::intern(std::string_view name) {
+    if (last_name_id_ != INVALID && name == last_name_) return last_name_id_;
+    uint32_t id;
+    auto it = by_name_.find(name);
+    if (it != by_name_.end()) {
+        id = it->second;
+    } else {
+        id = add(std::string(name));
+        if (id == INVALID) return INVALID;
+        by_name_.emplace(std::string(name), id);
+    }
+    last_name_.assign(name);
+    last_name_id_ = id;
+    return id;
+}
+
+uint32_t SymbolTable::intern_wire(uint32_t wire_id) {
+    if (last_wire_id_ != INVALID && wire_id == last_wire_) return last_wire_id_;
+    uint32_t id;
+    auto it = by_wire_.find(wire_id);
+    if (it != by_wire_.end()) {
+        id = it->second;
+    } else {
+        // formatted by hand: "#" + std::to_string trips a GCC 12 -Wrestrict false positive at -O3
+        char name[16];
+        int n = std::snprintf(name, sizeof(name), "#%u", wire_id);
+        id = add(std::string(name, size_t(n)));
+        if (id == INVALID) return INVALID;
+        by_wire_.emplace(wire_id, id);
+    }
+    last_wire_ = wire_id;
+    last_wire_id_ = id;
+    return id;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/*
+ Interns instrument keys into dense ids 0..N-1.
+ - CSV feeds identify a symbol by name, binary feeds by a 32-bit wire id;
+   both map into the same dense id space
+ - capacity is fixed at construction; keys seen after the table is full
+   map to INVALID and are counted as overflow
+ - only the first sighting of a key allocates; repeat lookups are a hash probe
+   (short-circuited when consecutive ticks share a symbol)
+*/
+
+class SymbolTable {
+public:
+    static constexpr uint32_t INVALID = UINT32_MAX;
+
+    explicit SymbolTable(size_t capacity = 4096);
+
+    uint32_t intern(std::string_view name);
+    uint32_t intern_wire(uint32_t wire_id);
+
+    size_t size() const { return names_.size(); }
+    size_t capacity() const { return capacity_; }
+    uint64_t overflow() const { return overflow_; }
+    const std::string& name(uint32_t id) const { return names_[id]; }
+
+private:
+    struct Hash {
+        using is_transparent = void;
+        size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+    };
+
+    size_t capacity_;
+    std::unordered_map<std::string, uint32_t, Hash, std::equal_to<>> by_name_;
+    std::unordered_map<uint32_t, uint32_t> by_wire_;
+    std::vector<std::string> names_;
+    uint64_t overflow_ = 0;
+
+    // last lookup, so runs of ticks for one symbol skip the hash
+    std::string last_name_;
+    uint32_t last_name_id_ = INVALID;
+    uint32_t last_wire_ = 0;
+    uint32_t last_wire_id_ = INVALID;
+
+    uint32_t add(std::string name);
+};
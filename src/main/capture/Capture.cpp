@@ -0,0 +1,140 @@
+#include "Capture.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+constexpr size_t WRITE_BUF = 1 << 20;
+
+inline size_t padded(size_t len) { return (len + 7) & ~size_t(7); }
+
+bool write_all(int fd, const char* p, size_t n) {
+    while (n > 0) {
+        ssize_t w = ::write(fd, p, n);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += w;
+        n -= size_t(w);
+    }
+    return true;
+}
+
+} // namespace
+
+CaptureWriter::~CaptureWriter() { close(); }
+
+bool CaptureWriter::open(const std::string& path, uint32_t ts_mode) {
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        perror("CaptureWriter: open");
+        return false;
+    }
+    fd_ = fd;
+    buf_.assign(WRITE_BUF, 0);
+    used_ = 0;
+    CaptureHeader h{};
+    std::memcpy(h.magic, "FICP", 4);
+    h.version = CAPTURE_VERSION;
+    h.ts_mode = ts_mode;
+    std::memcpy(buf_.data(), &h, sizeof(h));
+    used_ = sizeof(h);
+    return true;
+}
+
+void CaptureWriter::append(const char* data, size_t len, double recv_ts) {
+    if (fd_ < 0) return;
+    const size_t need = sizeof(CaptureRecord) + padded(len);
+    if (used_ + need > buf_.size()) {
+        flush();
+        // datagrams are far smaller than the buffer, but stay correct if one is not
+        if (need > buf_.size()) buf_.resize(need);
+    }
+    CaptureRecord r{recv_ts, uint32_t(len), 0};
+    char* p = buf_.data() + used_;
+    std::memcpy(p, &r, sizeof(r));
+    std::memcpy(p + sizeof(r), data, len);
+    std::memset(p + sizeof(r) + len, 0, padded(len) - len);
+    used_ += need;
+    ++records_;
+    bytes_ += need;
+}
+
+void CaptureWriter::flush() {
+    if (used_ == 0) return;
+    if (!write_all(fd_, buf_.data(), used_)) perror("CaptureWriter: write");
+    used_ = 0;
+}
+
+void CaptureWriter::close() {
+    if (fd_ < 0) return;
+    flush();
+    ::close(fd_);
+    fd_ = -1;
+}
+
+CaptureReader::~CaptureReader() {
+    if (base_) munmap(const_cast<char*>(base_), size_);
+}
+
+bool CaptureReader::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        perror("CaptureReader: open");
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(CaptureHeader)) {
+        std::fprintf(stderr, "CaptureReader: %s is not a capture file\n", path.c_str());
+        ::close(fd);
+        return false;
+    }
+    void* m = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (m == MAP_FAILED) {
+        perror("CaptureReader: mmap");
+        return false;
+    }
+    // read front to back exactly once
+    madvise(m, size_t(st.st_size), MADV_SEQUENTIAL);
+    base_ = static_cast<const char*>(m);
+    size_ = size_t(st.st_size);
+
+    CaptureHeader h;
+    std::memcpy(&h, base_, sizeof(h));
+    if (std::memcmp(h.magic, "FICP", 4) != 0 || h.version != CAPTURE_VERSION) {
+        std::fprintf(stderr, "CaptureReader: %s: bad magic or version %u\n", path.c_str(), h.version);
+        return false;
+    }
+    ts_mode_ = h.ts_mode;
+    pos_ = sizeof(h);
+    return true;
+}
+
+bool CaptureReader::next(const char*& data, size_t& len, double& recv_ts) {
+    if (size_ - pos_ < sizeof(CaptureRecord)) {
+        if (pos_ != size_ && truncated_ == 0) truncated_ = 1;
+        return false;
+    }
+    CaptureRecord r;
+    std::memcpy(&r, base_ + pos_, sizeof(r));
+    const size_t body = padded(r.length);
+    if (size_ - pos_ - sizeof(r) < body) {
+        truncated_ = 1;
+        pos_ = size_;
+        return false;
+    }
+    data = base_ + pos_ + sizeof(r);
+    len = r.length;
+    recv_ts = r.recv_ts;
+    pos_ += sizeof(r) + body;
+    return true;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ Datagram capture files for record / replay.
+ - layout: CaptureHeader, then one CaptureRecord per received datagram, each
+   followed by its payload padded to 8 bytes so records stay aligned
+ - the payload is stored exactly as received (CSV or binary wire format), with
+   the receive timestamp the ingest layer produced, so a replay feeds
+   Engine::decode the same bytes and recv_ts as the live run
+ - CaptureWriter appends through a 1 MiB buffer: the receive thread only pays a
+   memcpy per datagram plus one write() per MiB
+ - CaptureReader maps the whole file read-only and walks it in place; a record
+   cut short by a crash ends the replay and is counted as truncated
+*/
+
+struct CaptureHeader {
+    char magic[4];       // "FICP"
+    uint32_t version;    // 1
+    uint32_t ts_mode;    // UdpIngest::TimestampMode the capture was taken with
+    uint32_t reserved;
+};
+
+struct CaptureRecord {
+    double recv_ts;      // seconds since epoch, as passed to Engine::decode
+    uint32_t length;     // payload bytes
+    uint32_t reserved;
+};
+
+constexpr uint32_t CAPTURE_VERSION = 1;
+
+class CaptureWriter {
+public:
+    CaptureWriter() = default;
+    ~CaptureWriter();
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    // create/truncate `path` and write the header; false (with perror) on failure
+    bool open(const std::string& path, uint32_t ts_mode);
+    bool is_open() const { return fd_ >= 0; }
+    void append(const char* data, size_t len, double recv_ts);
+    // flush the buffer and close; safe to call twice
+    void close();
+
+    uint64_t records() const { return records_; }
+    uint64_t bytes() const { return bytes_; }
+
+private:
+    int fd_ = -1;
+    std::vector<char> buf_;
+    size_t used_ = 0;
+    uint64_t records_ = 0;
+    uint64_t bytes_ = 0;
+
+    void flush();
+};
+
+class CaptureReader {
+public:
+    CaptureReader() = default;
+    ~CaptureReader();
+    CaptureReader(const CaptureReader&) = delete;
+    CaptureReader& operator=(const CaptureReader&) = delete;
+
+    // map `path` and check the header; false (with a message on stderr) on failure
+    bool open(const std::string& path);
+    // next datagram; `data` points into the mapping and stays valid until the reader is destroyed
+    bool next(const char*& data, size_t& len, double& recv_ts);
+    // back to the first record
+    void rewind() { pos_ = sizeof(CaptureHeader); }
+
+    uint32_t ts_mode() const { return ts_mode_; }
+    size_t file_size() const { return size_; }
+    // 1 if the file ends in the middle of a record
+    uint64_t truncated() const { return truncated_; }
+
+private:
+    const char* base_ = nullptr;
+    size_t size_ = 0;
+    size_t pos_ = 0;
+    uint32_t ts_mode_ = 0;
+    uint64_t truncated_ = 0;
+};
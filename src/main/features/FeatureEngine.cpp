@@ -0,0 +1,133 @@
+#include "FeatureEngine.h"
+
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+std::string fmt_num(double v) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%g", v);
+    return buf;
+}
+
+inline double imbalance(double sum, double gross) { return gross > 0.0 ? sum / gross : 0.0; }
+
+} // namespace
+
+FeatureEngine::FeatureEngine(const FeatureConfig& cfg, size_t symbols)
+    : tick_w_(cfg.tick_windows), time_w_(cfg.time_windows_s) {
+    size_t need = cfg.capacity;
+    for (uint32_t n : tick_w_) if (n > need) need = n;
+    cap_ = 1;
+    while (cap_ < need) cap_ <<= 1;
+    mask_ = cap_ - 1;
+
+    // per-tick decay for a half-life of h ticks: (1 - a)^h = 1/2
+    for (double h : cfg.ewma_halflives) ewma_alpha_.push_back(h > 0.0 ? 1.0 - std::exp2(-1.0 / h) : 1.0);
+
+    names_.push_back("ofi");
+    for (double h : cfg.ewma_halflives) names_.push_back("ewma_h" + fmt_num(h));
+    for (uint32_t n : tick_w_) {
+        names_.push_back("ofi_" + std::to_string(n) + "t");
+        names_.push_back("imb_" + std::to_string(n) + "t");
+    }
+    for (double t : time_w_) {
+        names_.push_back("ofi_" + fmt_num(t) + "s");
+        names_.push_back("imb_" + fmt_num(t) + "s");
+        names_.push_back("rate_" + fmt_num(t) + "s");
+    }
+
+    ring_.resize(symbols);
+    head_.assign(symbols, 0);
+    tick_sum_.assign(symbols * tick_w_.size(), 0.0);
+    tick_gross_.assign(symbols * tick_w_.size(), 0.0);
+    time_sum_.assign(symbols * time_w_.size(), 0.0);
+    time_gross_.assign(symbols * time_w_.size(), 0.0);
+    time_tail_.assign(symbols * time_w_.size(), 0);
+    ewma_.assign(symbols * ewma_alpha_.size(), 0.0);
+    out_.assign(symbols * names_.size(), 0.0);
+}
+
+void FeatureEngine::reserve(uint32_t symbol) {
+    std::vector<Sample>& r = ring_[symbol];
+    if (r.empty()) r.assign(cap_, Sample{0.0, 0.0});
+}
+
+int FeatureEngine::index(const std::string& name) const {
+    for (size_t i = 0; i < names_.size(); ++i) {
+        if (names_[i] == name) return int(i);
+    }
+    return -1;
+}
+
+const double* FeatureEngine::update(uint32_t symbol, double ofi, double ts) {
+    const size_t s = symbol;
+    if (ring_[s].empty()) reserve(symbol);
+    Sample* ring = ring_[s].data();
+    const uint64_t pos = head_[s];
+    const size_t nk = tick_w_.size();
+    const size_t nt = time_w_.size();
+    double* tsum = &tick_sum_[s * nk];
+    double* tgross = &tick_gross_[s * nk];
+    double* wsum = &time_sum_[s * nt];
+    double* wgross = &time_gross_[s * nt];
+    uint64_t* tail = &time_tail_[s * nt];
+
+    // the slot about to be overwritten must first leave every window still holding it
+    for (size_t w = 0; w < nt; ++w) {
+        if (pos - tail[w] >= cap_) {
+            double old = ring[tail[w] & mask_].ofi;
+            wsum[w] -= old;
+            wgross[w] -= std::fabs(old);
+            ++tail[w];
+            ++overflow_;
+        }
+    }
+    for (size_t w = 0; w < nk; ++w) {
+        if (pos >= tick_w_[w]) {
+            double old = ring[(pos - tick_w_[w]) & mask_].ofi;
+            tsum[w] -= old;
+            tgross[w] -= std::fabs(old);
+        }
+    }
+    ring[pos & mask_] = Sample{ts, ofi};
+    head_[s] = pos + 1;
+
+    const double mag = std::fabs(ofi);
+    for (size_t w = 0; w < nk; ++w) {
+        tsum[w] += ofi;
+        tgross[w] += mag;
+    }
+    for (size_t w = 0; w < nt; ++w) {
+        wsum[w] += ofi;
+        wgross[w] += mag;
+        const double cutoff = ts - time_w_[w];
+        while (tail[w] < pos && ring[tail[w] & mask_].ts <= cutoff) {
+            double old = ring[tail[w] & mask_].ofi;
+            wsum[w] -= old;
+            wgross[w] -= std::fabs(old);
+            ++tail[w];
+        }
+    }
+
+    double* out = &out_[s * names_.size()];
+    double* ew = &ewma_[s * ewma_alpha_.size()];
+    size_t k = 0;
+    out[k++] = ofi;
+    for (size_t h = 0; h < ewma_alpha_.size(); ++h) {
+        const double a = ewma_alpha_[h];
+        ew[h] = a * ofi + (1.0 - a) * ew[h];
+        out[k++] = ew[h];
+    }
+    for (size_t w = 0; w < nk; ++w) {
+        out[k++] = tsum[w];
+        out[k++] = imbalance(tsum[w], tgross[w]);
+    }
+    for (size_t w = 0; w < nt; ++w) {
+        out[k++] = wsum[w];
+        out[k++] = imbalance(wsum[w], wgross[w]);
+        out[k++] = double(pos + 1 - tail[w]) / time_w_[w];
+    }
+    return out;
+}
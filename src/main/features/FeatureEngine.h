@@ -0,0 +1,80 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ Incremental multi-horizon OFI features, per symbol.
+ - every OFI sample (from compute_ofi / SymbolStore::apply_tick) is appended
+   to the symbol's fixed-capacity ring of (recv_ts, ofi)
+ - tick windows: running OFI sum and gross flow (sum |ofi|) over the last N
+   samples; the sample leaving the window is read back from the ring
+ - time windows: the same over samples with recv_ts in (now - T, now], plus the
+   sample rate; each window keeps its own tail in the ring and evicts from it,
+   so every sample enters and leaves each window once (amortised O(1))
+ - EWMAs of OFI for several half-lives (in ticks)
+ - normalized imbalance = sum / gross, in [-1, 1] (0 with no flow)
+ OFI is integral, so the running sums are exact; no periodic recompute is needed.
+ The constructor allocates only the per-symbol aggregates (a few values per
+ window). A symbol's ring (capacity x 16 bytes) is allocated by reserve(),
+ which Engine::decode calls when the symbol is interned, so memory follows
+ the symbols actually seen rather than max_symbols; update() on a symbol
+ never reserved allocates its ring there, once. If a time window holds more than
+ `capacity` samples, its oldest samples are evicted early and counted in
+ overflow_evictions(); size the capacity for the peak per-symbol rate times
+ the longest window.
+*/
+
+struct FeatureConfig {
+    std::vector<uint32_t> tick_windows{10, 100, 1000};
+    std::vector<double> time_windows_s{0.1, 1.0, 10.0};
+    std::vector<double> ewma_halflives{5.0, 50.0, 500.0};
+    // ring entries per symbol; rounded up to a power of two and to the largest tick window
+    size_t capacity = 4096;
+};
+
+class FeatureEngine {
+public:
+    FeatureEngine(const FeatureConfig& cfg, size_t symbols);
+
+    // allocate the ring of `symbol` ahead of its first update()
+    void reserve(uint32_t symbol);
+
+    // fold one OFI sample of `symbol` received at `ts` (seconds) and return the
+    // symbol's feature vector: size() values, valid until the next update()
+    const double* update(uint32_t symbol, double ofi, double ts);
+
+    // vector layout: ofi, ewma_h<h>..., ofi_<n>t, imb_<n>t..., ofi_<T>s, imb_<T>s, rate_<T>s...
+    size_t size() const { return names_.size(); }
+    const std::vector<std::string>& names() const { return names_; }
+    // index of a feature by name, -1 if unknown
+    int index(const std::string& name) const;
+
+    size_t capacity() const { return cap_; }
+    uint64_t overflow_evictions() const { return overflow_; }
+
+private:
+    size_t cap_;
+    size_t mask_;
+    std::vector<uint32_t> tick_w_;
+    std::vector<double> time_w_;
+    std::vector<double> ewma_alpha_;
+    std::vector<std::string> names_;
+
+    struct Sample {
+        double ts;
+        double ofi;
+    };
+    // per symbol: ring of cap_ samples (empty until reserved) and the count ever pushed
+    std::vector<std::vector<Sample>> ring_;
+    std::vector<uint64_t> head_;
+    // per symbol x window aggregates
+    std::vector<double> tick_sum_, tick_gross_;
+    std::vector<double> time_sum_, time_gross_;
+    std::vector<uint64_t> time_tail_;  // absolute index of the oldest sample in the window
+    std::vector<double> ewma_;
+    // per symbol output vector
+    std::vector<double> out_;
+    uint64_t overflow_ = 0;
+};
@@ -0,0 +1,56 @@
+#include "Echo.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+EchoSender::~EchoSender() {
+    if (sock_ >= 0) close(sock_);
+}
+
+bool EchoSender::open(const std::string& dest, uint32_t every) {
+    const size_t colon = dest.rfind(':');
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    if (colon == std::string::npos || inet_pton(AF_INET, dest.substr(0, colon).c_str(), &addr.sin_addr) != 1) {
+        std::cerr << "echo: expected <ipv4>:<port>, got " << dest << "\n";
+        return false;
+    }
+    const int port = std::atoi(dest.c_str() + colon + 1);
+    if (port <= 0 || port > 65535) {
+        std::cerr << "echo: bad port in " << dest << "\n";
+        return false;
+    }
+    addr.sin_port = htons(uint16_t(port));
+    int s = socket(AF_INET, SOCK_DGRAM, 0);
+    if (s < 0 || connect(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        perror("echo: socket/connect");
+        if (s >= 0) close(s);
+        return false;
+    }
+    if (sock_ >= 0) close(sock_);
+    sock_ = s;
+    every_ = every > 0 ? every : 1;
+    return true;
+}
+
+void EchoSender::send(const Tick& t, int action) {
+    EchoRecord r;
+    r.magic = ECHO_MAGIC;
+    r.action = action;
+    r.seq = t.seq;
+    r.src_ts = t.src_ts;
+    r.recv_ts = t.recv_ts;
+    r.send_ts = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+    // never blocks the tick path: a full socket buffer loses the ack, not the tick
+    if (::send(sock_, &r, sizeof(r), MSG_DONTWAIT) == ssize_t(sizeof(r))) ++sent_;
+    else ++errors_;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "../OrderBook.h"
+
+/*
+ Echo / ack channel for closed-loop latency measurement (--echo=<host>:<port>).
+ - after Engine::process, every `every`-th seq is acknowledged with one
+   EchoRecord datagram to the load generator (flow_imbalance_loadgen
+   --echo-port), carrying the tick's own src_ts back with the engine's
+   receive and ack times
+ - the generator subtracts src_ts from its clock at arrival: the full round
+   trip through both kernels, decode, OFI and predictor, measured on one
+   clock; recv_ts / send_ts split it into in / engine / out legs
+ - one connected socket per sending thread, one send() per ack: sample
+   sparsely (the default acks 1 tick in 100) so the syscall stays off most ticks
+*/
+
+#pragma pack(push, 1)
+struct EchoRecord {
+    uint32_t magic;    // ECHO_MAGIC
+    int32_t action;    // 1=BUY, -1=SELL, 0=HOLD
+    uint64_t seq;
+    double src_ts;     // copied from the tick (the generator's clock)
+    double recv_ts;    // engine receive time
+    double send_ts;    // engine clock when the ack was sent
+};
+#pragma pack(pop)
+
+static_assert(sizeof(EchoRecord) == 40, "EchoRecord is a wire format");
+
+constexpr uint32_t ECHO_MAGIC = 0x43454946;  // "FIEC" little-endian
+
+class EchoSender {
+public:
+    EchoSender() = default;
+    ~EchoSender();
+    EchoSender(const EchoSender&) = delete;
+    EchoSender& operator=(const EchoSender&) = delete;
+
+    // `dest` is <ipv4>:<port>; false after printing why
+    bool open(const std::string& dest, uint32_t every);
+    bool enabled() const { return sock_ >= 0; }
+
+    // ack `t` if its seq is sampled
+    void on_tick(const Tick& t, int action) {
+        if (sock_ >= 0 && t.seq % every_ == 0) send(t, action);
+    }
+
+    uint64_t sent() const { return sent_; }
+    uint64_t errors() const { return errors_; }
+
+private:
+    int sock_ = -1;
+    uint32_t every_ = 1;
+    uint64_t sent_ = 0;
+    uint64_t errors_ = 0;
+
+    void send(const Tick& t, int action);
+};
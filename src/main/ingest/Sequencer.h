@@ -0,0 +1,208 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../OrderBook.h"
+
+/*
+ Feed sequencing stage between decode and OFI: restores `Tick::seq` order.
+ - ticks at the expected seq go straight through; early ones are held in a
+   fixed window of `window` seqs until the gap before them fills
+ - a gap is given up when it has been open for `timeout` seconds or when a
+   tick arrives more than `window` seqs ahead; missing seqs are counted as
+   dropped and the `gap` callback runs before the next tick is released, so
+   the consumer can reset state that assumed consecutive ticks (prev_tick)
+ - already delivered seqs are duplicates, seqs that were given up are late;
+   both are discarded. A tick far behind with a newer src_ts than anything
+   delivered is taken as a publisher restart and restarts the sequence
+ - time is whatever the caller passes as `now` (recv_ts on arrival, wall
+   clock when idle), so replays of a capture sequence identically
+ - slots are allocated once; push/poll never allocate
+*/
+
+struct SequencerCounters {
+    uint64_t in_order = 0;    // released on arrival
+    uint64_t reordered = 0;   // held, then released once the seqs before it arrived or were given up
+    uint64_t duplicates = 0;  // seq already delivered or already held
+    uint64_t late = 0;        // arrived after its seq was given up
+    uint64_t gaps = 0;        // runs of missing seqs given up (timeout or window overflow)
+    uint64_t dropped = 0;     // seqs in those runs
+    uint64_t resets = 0;      // publisher restarts
+    uint64_t max_held = 0;
+};
+
+class Sequencer {
+public:
+    // `window` is rounded up to a power of two
+    explicit Sequencer(size_t window = 256, double timeout_s = 0.05);
+
+    // offer one tick; emit(const Tick&) runs for every tick that can be released
+    // in order, gap() once before the first tick after each skipped run
+    template <typename Emit, typename Gap>
+    void push(const Tick& t, double now, Emit&& emit, Gap&& gap);
+    // give up gaps older than the timeout; call when no ticks arrive
+    template <typename Emit, typename Gap>
+    void poll(double now, Emit&& emit, Gap&& gap);
+    // release everything held, skipping what is still missing (end of stream)
+    template <typename Emit, typename Gap>
+    void flush(Emit&& emit, Gap&& gap);
+
+    size_t held() const { return held_; }
+    size_t window() const { return window_; }
+    double timeout() const { return timeout_; }
+    const SequencerCounters& counters() const { return c_; }
+
+private:
+    enum : uint8_t { EMPTY = 0, HELD, DONE };
+    struct Slot {
+        Tick tick;
+        uint64_t seq;
+        uint8_t state;
+    };
+
+    // twice the window: the `window` seqs behind next_ remember what was delivered
+    std::vector<Slot> slots_;
+    uint64_t mask_;
+    size_t window_;
+    double timeout_;
+    bool started_ = false;
+    uint64_t next_ = 0;        // next seq to release
+    size_t held_ = 0;
+    double gap_since_ = 0.0;   // when the current gap started holding ticks, 0 if none
+    double last_src_ts_ = 0.0;
+    SequencerCounters c_;
+
+    Slot& slot(uint64_t seq) { return slots_[seq & mask_]; }
+    bool is_held(uint64_t seq) { const Slot& s = slot(seq); return s.state == HELD && s.seq == seq; }
+
+    template <typename Emit>
+    void release(const Tick& t, Emit& emit) {
+        Slot& s = slot(t.seq);
+        s.seq = t.seq;
+        s.state = DONE;
+        if (t.src_ts > last_src_ts_) last_src_ts_ = t.src_ts;
+        ++next_;
+        emit(t);
+    }
+    // release held ticks that are now in order
+    template <typename Emit>
+    void drain(Emit& emit) {
+        while (held_ > 0 && is_held(next_)) {
+            Slot& s = slot(next_);
+            s.state = DONE;
+            --held_;
+            ++c_.reordered;
+            if (s.tick.src_ts > last_src_ts_) last_src_ts_ = s.tick.src_ts;
+            ++next_;
+            emit(s.tick);
+        }
+    }
+    // give up the missing run at next_ (up to the first held seq, or `limit`)
+    template <typename Gap>
+    void skip_missing(uint64_t limit, Gap& gap) {
+        uint64_t from = next_;
+        while (next_ < limit && !is_held(next_)) ++next_;
+        if (next_ == from) return;
+        c_.dropped += next_ - from;
+        ++c_.gaps;
+        gap();
+    }
+    template <typename Emit, typename Gap>
+    void release_all_held(Emit& emit, Gap& gap) {
+        while (held_ > 0) {
+            skip_missing(next_ + window_, gap);
+            drain(emit);
+        }
+        gap_since_ = 0.0;
+    }
+    void restart_gap_timer(double now) { gap_since_ = held_ > 0 ? now : 0.0; }
+};
+
+inline Sequencer::Sequencer(size_t window, double timeout_s) : timeout_(timeout_s) {
+    size_t w = 2;
+    while (w < window) w <<= 1;
+    window_ = w;
+    slots_.assign(2 * w, Slot{Tick{}, 0, EMPTY});
+    mask_ = 2 * w - 1;
+}
+
+template <typename Emit, typename Gap>
+void Sequencer::push(const Tick& t, double now, Emit&& emit, Gap&& gap) {
+    if (held_ > 0) poll(now, emit, gap);
+    if (!started_) {
+        started_ = true;
+        next_ = t.seq;
+    }
+    const uint64_t s = t.seq;
+
+    if (s < next_) {
+        if (next_ - s <= window_) {
+            const Slot& sl = slot(s);
+            if (sl.state == DONE && sl.seq == s) ++c_.duplicates;
+            else ++c_.late;
+            return;
+        }
+        if (t.src_ts <= last_src_ts_) {
+            ++c_.late;
+            return;
+        }
+        // far behind but newer than anything seen: the publisher restarted its sequence
+        ++c_.resets;
+        release_all_held(emit, gap);
+        next_ = s;
+        gap();
+    } else if (s - next_ >= window_) {
+        // too far ahead to hold: give up everything missing before the window that ends at s
+        const uint64_t start = s - window_ + 1;
+        if (start - next_ > window_) {
+            release_all_held(emit, gap);  // nothing held lies beyond next_ + window
+            if (next_ < start) {
+                c_.dropped += start - next_;
+                ++c_.gaps;
+                next_ = start;
+                gap();
+            }
+        } else {
+            while (next_ < start) {
+                skip_missing(start, gap);
+                drain(emit);
+            }
+        }
+        restart_gap_timer(now);
+    }
+
+    if (s == next_) {
+        ++c_.in_order;
+        release(t, emit);
+        drain(emit);
+        restart_gap_timer(now);
+        return;
+    }
+    Slot& sl = slot(s);
+    if (sl.state == HELD && sl.seq == s) {
+        ++c_.duplicates;
+        return;
+    }
+    sl.tick = t;
+    sl.seq = s;
+    sl.state = HELD;
+    if (++held_ > c_.max_held) c_.max_held = held_;
+    if (gap_since_ == 0.0) gap_since_ = now;
+}
+
+template <typename Emit, typename Gap>
+void Sequencer::poll(double now, Emit&& emit, Gap&& gap) {
+    while (held_ > 0 && now - gap_since_ >= timeout_) {
+        skip_missing(next_ + window_, gap);
+        drain(emit);
+        // a further gap, if any, gets a full timeout of its own
+        restart_gap_timer(now);
+        if (held_ > 0) break;
+    }
+}
+
+template <typename Emit, typename Gap>
+void Sequencer::flush(Emit&& emit, Gap&& gap) {
+    release_all_held(emit, gap);
+}
@@ -0,0 +1,143 @@
+#include "UdpIngest.h"
+
+#include <linux/net_tstamp.h>
+#include <linux/sock_diag.h>
+#include <sys/socket.h>
+#include <time.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+UdpIngest::UdpIngest(int sock, size_t batch_size, size_t max_datagram, TimestampMode mode)
+    : sock_(sock),
+      batch_size_(batch_size == 0 ? 1 : batch_size),
+      max_datagram_(max_datagram),
+      slot_sz_(max_datagram + 1), // +1 for NUL terminator
+      mode_(mode) {
+    bufs_.assign(batch_size_ * slot_sz_, '\0');
+    ctrl_.assign(batch_size_ * CTRL_SZ, '\0');
+    iovs_.resize(batch_size_);
+    msgs_.resize(batch_size_);
+    recv_ts_.assign(batch_size_, 0.0);
+    batch_hist_.assign(batch_size_ + 1, 0);
+    for (size_t i = 0; i < batch_size_; ++i) {
+        iovs_[i].iov_base = &bufs_[i * slot_sz_];
+        iovs_[i].iov_len = max_datagram_;
+    }
+    reset_headers(batch_size_);
+}
+
+const char* UdpIngest::mode_name(TimestampMode m) {
+    switch (m) {
+        case TimestampMode::KernelNs: return "kernel(SO_TIMESTAMPNS)";
+        case TimestampMode::KernelTimestamping: return "kernel(SO_TIMESTAMPING)";
+        default: return "user";
+    }
+}
+
+bool UdpIngest::init() {
+    if (mode_ == TimestampMode::KernelNs) {
+        int on = 1;
+        if (setsockopt(sock_, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) < 0) {
+            perror("setsockopt(SO_TIMESTAMPNS)");
+            mode_ = TimestampMode::User;
+            return false;
+        }
+    } else if (mode_ == TimestampMode::KernelTimestamping) {
+        int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+        if (setsockopt(sock_, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) < 0) {
+            perror("setsockopt(SO_TIMESTAMPING)");
+            mode_ = TimestampMode::User;
+            return false;
+        }
+    }
+    return true;
+}
+
+uint64_t UdpIngest::kernel_drops() const {
+    uint32_t mem[SK_MEMINFO_VARS] = {};
+    socklen_t len = sizeof(mem);
+    if (getsockopt(sock_, SOL_SOCKET, SO_MEMINFO, mem, &len) < 0 || len <= SK_MEMINFO_DROPS * sizeof(uint32_t)) return 0;
+    return mem[SK_MEMINFO_DROPS];
+}
+
+void UdpIngest::reset_headers(size_t count) {
+    // recvmmsg overwrites msg_controllen / msg_flags, so restore them before every call
+    const bool want_ctrl = mode_ != TimestampMode::User;
+    for (size_t i = 0; i < count; ++i) {
+        msghdr& h = msgs_[i].msg_hdr;
+        h.msg_name = nullptr;
+        h.msg_namelen = 0;
+        h.msg_iov = &iovs_[i];
+        h.msg_iovlen = 1;
+        h.msg_control = want_ctrl ? &ctrl_[i * CTRL_SZ] : nullptr;
+        h.msg_controllen = want_ctrl ? CTRL_SZ : 0;
+        h.msg_flags = 0;
+    }
+}
+
+bool UdpIngest::kernel_ts(const msghdr& hdr, int64_t& out_ns) const {
+    for (cmsghdr* c = CMSG_FIRSTHDR(&hdr); c != nullptr; c = CMSG_NXTHDR(const_cast<msghdr*>(&hdr), c)) {
+        if (c->cmsg_level != SOL_SOCKET) continue;
+        if (c->cmsg_type == SCM_TIMESTAMPNS) {
+            timespec ts;
+            std::memcpy(&ts, CMSG_DATA(c), sizeof(ts));
+            out_ns = int64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+            return true;
+        }
+        if (c->cmsg_type == SCM_TIMESTAMPING) {
+            // scm_timestamping: ts[0] = software, ts[2] = raw hardware
+            timespec ts[3];
+            std::memcpy(ts, CMSG_DATA(c), sizeof(ts));
+            const timespec& t = (ts[0].tv_sec != 0 || ts[0].tv_nsec != 0) ? ts[0] : ts[2];
+            if (t.tv_sec == 0 && t.tv_nsec == 0) return false;
+            out_ns = int64_t(t.tv_sec) * 1000000000 + t.tv_nsec;
+            return true;
+        }
+    }
+    return false;
+}
+
+int UdpIngest::receive_batch() {
+    // MSG_WAITFORONE: block for the first datagram, then take only what is already queued;
+    // MSG_DONTWAIT (busy poll): take only what is queued, possibly nothing
+    const int flags = busy_poll_ ? MSG_DONTWAIT : MSG_WAITFORONE;
+    int n = recvmmsg(sock_, msgs_.data(), static_cast<unsigned int>(batch_size_), flags, nullptr);
+    if (n <= 0) {
+        if (n < 0 && errno != EINTR && errno != EAGAIN) perror("recvmmsg");
+        else if (n < 0 && errno == EAGAIN && busy_poll_) ++empty_polls_;
+        return 0;
+    }
+    ++syscalls_;
+    datagrams_ += uint64_t(n);
+    ++batch_hist_[size_t(n)];
+
+    // one user-space stamp per batch; also the fallback when a kernel stamp is missing
+    const int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    const double now = double(now_ns) * 1e-9;
+
+    for (int i = 0; i < n; ++i) {
+        size_t len = msgs_[size_t(i)].msg_len;
+        if (len > max_datagram_) len = max_datagram_;
+        bufs_[size_t(i) * slot_sz_ + len] = '\0';
+
+        double ts = now;
+        if (mode_ != TimestampMode::User) {
+            int64_t kts_ns;
+            if (!kernel_ts(msgs_[size_t(i)].msg_hdr, kts_ns)) {
+                ++missing_kernel_ts_;
+            } else {
+                ts = double(kts_ns) * 1e-9;
+                // integer ns: epoch seconds in a double only resolve ~0.2us
+                kernel_to_user_ns_.record_signed(now_ns - kts_ns);
+            }
+        }
+        recv_ts_[size_t(i)] = ts;
+    }
+    reset_headers(size_t(n));
+    return n;
+}
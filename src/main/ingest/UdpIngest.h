@@ -0,0 +1,92 @@
+#pragma once
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../stats/LatencyHistogram.h"
+
+/*
+ Batched UDP receive layer.
+ - drains up to `batch_size` datagrams per recvmmsg() syscall
+ - all datagram, iovec and control buffers are allocated once up front
+ - receive timestamps come either from user space (clock after the syscall)
+   or from the kernel via SO_TIMESTAMPNS / SO_TIMESTAMPING control messages;
+   with kernel stamps, the kernel -> user-space delay (wakeup jitter) is recorded
+ - busy-poll mode never blocks: receive_batch() returns 0 at once when the
+   queue is empty and the caller spins
+ - keeps a histogram of how many datagrams each syscall returned
+*/
+
+class UdpIngest {
+public:
+    enum class TimestampMode { User = 0, KernelNs, KernelTimestamping };
+
+    // `sock` must be a bound UDP socket; ownership stays with the caller
+    UdpIngest(int sock, size_t batch_size = 64, size_t max_datagram = 2048,
+              TimestampMode mode = TimestampMode::User);
+
+    // configure the socket for the requested timestamp mode.
+    // returns false (and reverts to User mode) if the kernel refuses the option
+    bool init();
+
+    // block until at least one datagram arrives, then drain whatever else is queued
+    // (up to batch_size). returns number of datagrams received, 0 on EINTR/error.
+    // in busy-poll mode it does not wait and returns 0 when nothing is queued
+    int receive_batch();
+
+    void set_busy_poll(bool on) { busy_poll_ = on; }
+    bool busy_poll() const { return busy_poll_; }
+
+    // accessors for datagram i of the last batch; payloads are NUL-terminated
+    const char* data(int i) const { return &bufs_[size_t(i) * slot_sz_]; }
+    size_t length(int i) const { return msgs_[size_t(i)].msg_len; }
+    // receive time in seconds since epoch
+    double recv_ts(int i) const { return recv_ts_[size_t(i)]; }
+
+    TimestampMode mode() const { return mode_; }
+    size_t batch_size() const { return batch_size_; }
+    uint64_t syscalls() const { return syscalls_; }
+    uint64_t datagrams() const { return datagrams_; }
+    // kernel mode only: datagrams that arrived without a usable timestamp cmsg
+    uint64_t missing_kernel_ts() const { return missing_kernel_ts_; }
+    // kernel modes only: receive timestamp -> back in user space after the syscall, in ns
+    const LatencyHistogram& kernel_to_user_ns() const { return kernel_to_user_ns_; }
+    // busy-poll mode: receive calls that found the queue empty
+    uint64_t empty_polls() const { return empty_polls_; }
+    // datagrams the kernel dropped on this socket (receive buffer full), via SO_MEMINFO;
+    // a getsockopt call, not for the hot path. 0 if the kernel does not report it
+    uint64_t kernel_drops() const;
+    // batch_hist()[k] = number of syscalls that returned exactly k datagrams
+    const std::vector<uint64_t>& batch_hist() const { return batch_hist_; }
+
+    static const char* mode_name(TimestampMode m);
+
+private:
+    int sock_;
+    size_t batch_size_;
+    size_t max_datagram_;
+    size_t slot_sz_;
+    TimestampMode mode_;
+    bool busy_poll_ = false;
+
+    std::vector<char> bufs_;
+    std::vector<char> ctrl_;
+    std::vector<iovec> iovs_;
+    std::vector<mmsghdr> msgs_;
+    std::vector<double> recv_ts_;
+    std::vector<uint64_t> batch_hist_;
+
+    uint64_t syscalls_ = 0;
+    uint64_t datagrams_ = 0;
+    uint64_t missing_kernel_ts_ = 0;
+    uint64_t empty_polls_ = 0;
+    LatencyHistogram kernel_to_user_ns_;
+
+    static constexpr size_t CTRL_SZ = 256;
+
+    void reset_headers(size_t count);
+    bool kernel_ts(const msghdr& hdr, int64_t& out_ns) const;
+};
@@ -0,0 +1,89 @@
+#include "UdpSocket.h"
+
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+bool join_group(int sock, const std::string& group, const std::string& iface) {
+    ip_mreqn mreq;
+    std::memset(&mreq, 0, sizeof(mreq));
+    if (inet_pton(AF_INET, group.c_str(), &mreq.imr_multiaddr) != 1 || !IN_MULTICAST(ntohl(mreq.imr_multiaddr.s_addr))) {
+        std::cerr << "multicast: " << group << " is not an IPv4 multicast address\n";
+        return false;
+    }
+    if (!iface.empty()) {
+        // an address selects the interface that owns it, anything else is an interface name
+        if (inet_pton(AF_INET, iface.c_str(), &mreq.imr_address) != 1) {
+            mreq.imr_ifindex = int(if_nametoindex(iface.c_str()));
+            if (mreq.imr_ifindex == 0) {
+                std::cerr << "multicast: unknown interface " << iface << "\n";
+                return false;
+            }
+        }
+    }
+    if (setsockopt(sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+        perror(("setsockopt(IP_ADD_MEMBERSHIP " + group + ")").c_str());
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int open_udp_socket(const UdpSocketConfig& cfg) {
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0) { perror("socket"); return -1; }
+    auto fail = [&](const char* what) {
+        perror(what);
+        close(sock);
+        return -1;
+    };
+    int on = 1;
+    if (cfg.reuse_port && setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) < 0) {
+        return fail("setsockopt(SO_REUSEPORT)");
+    }
+    if (cfg.rcvbuf > 0 && setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &cfg.rcvbuf, sizeof(cfg.rcvbuf)) < 0) {
+        return fail("setsockopt(SO_RCVBUF)");
+    }
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(uint16_t(cfg.port));
+    if (bind(sock, (sockaddr*)&addr, sizeof(addr)) < 0) return fail("bind");
+
+    if (!cfg.groups.empty()) {
+        // without this a wildcard-bound socket also gets groups joined by other sockets on the host
+        int off = 0;
+        if (setsockopt(sock, IPPROTO_IP, IP_MULTICAST_ALL, &off, sizeof(off)) < 0) return fail("setsockopt(IP_MULTICAST_ALL)");
+        for (const std::string& g : cfg.groups) {
+            if (!join_group(sock, g, cfg.iface)) {
+                close(sock);
+                return -1;
+            }
+        }
+    }
+    return sock;
+}
+
+bool set_receive_timeout(int sock, double seconds) {
+    timeval tv;
+    tv.tv_sec = time_t(seconds);
+    tv.tv_usec = suseconds_t((seconds - double(tv.tv_sec)) * 1e6);
+    // a zero timeval would mean "block forever"
+    if (tv.tv_sec == 0 && tv.tv_usec < 100) tv.tv_usec = 100;
+    if (setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) < 0) {
+        perror("setsockopt(SO_RCVTIMEO)");
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <string>
+#include <vector>
+
+/*
+ UDP socket setup shared by the single-socket and sharded receivers.
+ - binds INADDR_ANY:port; with `reuse_port` several sockets may bind the same
+   port and the kernel spreads flows across them (hash of the 4-tuple, so one
+   publisher's flow always lands on the same socket)
+ - joins each multicast group in `groups` on `iface` (interface name or IPv4
+   address; empty lets the kernel pick by route) and turns off
+   IP_MULTICAST_ALL so only joined groups are delivered
+*/
+
+struct UdpSocketConfig {
+    int port = 9000;
+    bool reuse_port = false;
+    std::vector<std::string> groups;
+    std::string iface;
+    // SO_RCVBUF in bytes, 0 = system default
+    int rcvbuf = 0;
+};
+
+// returns the bound socket, or -1 after printing why
+int open_udp_socket(const UdpSocketConfig& cfg);
+
+// SO_RCVTIMEO; receive calls return 0 after `seconds` without traffic
+bool set_receive_timeout(int sock, double seconds);
@@ -0,0 +1,107 @@
+#include "SignalLog.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+int format_decision(char* buf, size_t cap, const Decision& d, std::string_view symbol) {
+    const char* act = d.action > 0 ? "BUY" : "SELL";
+    // the bank vote only appears with --bank, so lines without one keep their old shape
+    char bank[32] = "";
+    if (d.bank_configs > 0) std::snprintf(bank, sizeof(bank), " bank=%+d/%u", d.bank_vote, d.bank_configs);
+    int n = std::snprintf(buf, cap, "[%llu] %s sym=%.*s ewma=%.2f ofi=%.2f%s recv->dec(us)=%.2f src->recv(us)=%.2f\n",
+                          (unsigned long long)d.seq, act, int(symbol.size()), symbol.data(), d.ewma, d.ofi, bank,
+                          d.recv_to_decision_ns / 1000.0, (d.recv_ts - d.src_ts) * 1e6);
+    if (n < 0) return 0;
+    return size_t(n) < cap ? n : int(cap - 1);
+}
+
+SignalLog::SignalLog(size_t capacity, const SymbolTable& symbols) : ring_(capacity), symbols_(symbols) {}
+
+SignalLog::~SignalLog() { stop(); }
+
+bool SignalLog::open_binary(const std::string& path) {
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) {
+        perror("SignalLog: fopen");
+        return false;
+    }
+    // large stdio buffer: the writer thread issues few, big write() calls
+    std::setvbuf(f, nullptr, _IOFBF, 1 << 20);
+    SignalLogHeader h;
+    std::memcpy(h.magic, "FISL", 4);
+    h.version = SIGNAL_LOG_VERSION;
+    h.record_size = sizeof(Decision);
+    std::fwrite(&h, sizeof(h), 1, f);
+    file_ = f;
+    binary_ = true;
+    path_ = path;
+    return true;
+}
+
+void SignalLog::start() {
+    if (writer_.joinable()) return;
+    stopping_.store(false, std::memory_order_relaxed);
+    writer_ = std::thread([this] { run(); });
+}
+
+void SignalLog::write(const Decision& d, std::string& text) {
+    if (file_) {
+        std::fwrite(&d, sizeof(d), 1, file_);
+    } else {
+        char line[256];
+        const std::string& name = symbols_.name(d.symbol);
+        int n = format_decision(line, sizeof(line), d, name);
+        text.append(line, size_t(n));
+    }
+    written_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SignalLog::run() {
+    std::string text;
+    text.reserve(1 << 16);
+    Decision d;
+    for (;;) {
+        bool any = false;
+        while (ring_.try_pop(d)) {
+            write(d, text);
+            any = true;
+            if (text.size() >= (1 << 16) - 256) {
+                std::cout.write(text.data(), std::streamsize(text.size()));
+                text.clear();
+            }
+        }
+        if (!text.empty()) {
+            std::cout.write(text.data(), std::streamsize(text.size()));
+            std::cout.flush();
+            text.clear();
+        }
+        if (!any) {
+            // the producer stores everything before setting stopping_, so one more drain is enough
+            if (stopping_.load(std::memory_order_acquire)) {
+                while (ring_.try_pop(d)) write(d, text);
+                if (!text.empty()) std::cout.write(text.data(), std::streamsize(text.size()));
+                std::cout.flush();
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+}
+
+void SignalLog::stop() {
+    if (writer_.joinable()) {
+        stopping_.store(true, std::memory_order_release);
+        writer_.join();
+    }
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+        // symbol names, so the decoder can print them
+        FILE* f = std::fopen((path_ + ".symbols").c_str(), "w");
+        if (f) {
+            for (uint32_t id = 0; id < symbols_.size(); ++id) std::fprintf(f, "%u %s\n", id, symbols_.name(id).c_str());
+            std::fclose(f);
+        }
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "../Decision.h"
+#include "../SymbolTable.h"
+#include "../pipeline/SpscRing.h"
+
+/*
+ Asynchronous signal log.
+ - the hot thread only copies a fixed-size Decision into a preallocated SPSC
+   ring (no formatting, no iostream, no syscalls); a full ring drops and counts
+ - a background thread drains the ring and either formats text lines to stdout
+   or appends the raw records to a binary file
+ - binary file layout: SignalLogHeader followed by back-to-back Decision records;
+   symbol names are written to `<path>.symbols` ("<id> <name>" per line) on stop()
+ - flow_imbalance_logdump turns binary logs back into the text format
+*/
+
+struct SignalLogHeader {
+    char magic[4];         // "FISL"
+    uint32_t version;      // 2 (1: 56-byte records without the bank fields)
+    uint32_t record_size;  // sizeof(Decision)
+};
+
+constexpr uint32_t SIGNAL_LOG_VERSION = 2;
+
+// format one decision as a text line (with trailing newline); returns length written
+int format_decision(char* buf, size_t cap, const Decision& d, std::string_view symbol);
+
+class SignalLog {
+public:
+    // names for text output are looked up in `symbols` by id on the background thread;
+    // ids must be interned before the decision is logged
+    SignalLog(size_t capacity, const SymbolTable& symbols);
+    ~SignalLog();
+
+    // switch to binary output; call before start(). returns false if the file cannot be opened
+    bool open_binary(const std::string& path);
+    void start();
+    // hot path: enqueue one record, false (and counted) if the ring is full. single producer only
+    bool log(const Decision& d) { return ring_.try_push(d); }
+    // same, but waits for the writer when the ring is full (offline replay)
+    void log_wait(const Decision& d) { ring_.push(d); }
+    // drain remaining records, join the writer and close the file
+    void stop();
+
+    bool binary() const { return binary_; }
+    uint64_t written() const { return written_.load(std::memory_order_relaxed); }
+    uint64_t drops() const { return ring_.drops(); }
+    uint64_t high_water() const { return ring_.high_water(); }
+    // records waiting for the writer thread
+    size_t depth() const { return ring_.size(); }
+    size_t capacity() const { return ring_.capacity(); }
+
+private:
+    SpscRing<Decision> ring_;
+    const SymbolTable& symbols_;
+    std::string path_;
+    FILE* file_ = nullptr;
+    bool binary_ = false;
+    std::thread writer_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<uint64_t> written_{0};
+
+    void run();
+    void write(const Decision& d, std::string& text);
+};
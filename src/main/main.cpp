@@ -3,6 +3,7 @@
 #include <sys/socket.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <chrono>
 #include <cstring>
 #include <iostream>
@@ -13,26 +14,138 @@
 #include <signal.h>
 #include <iomanip>
 
-#include "OrderBook.h"
-#include "OFI.h"
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "Engine.h"
+#include "capture/Capture.h"
 #include "predictor/Predictor.h"
-#include <numeric>
-#include <algorithm>
+#include "ingest/Echo.h"
+#include "ingest/Sequencer.h"
+#include "ingest/UdpIngest.h"
+#include "ingest/UdpSocket.h"
+#include "log/SignalLog.h"
+#include "metrics/SharedMetrics.h"
+#include "pipeline/ReceiverShard.h"
+#include "pipeline/SpscRing.h"
+#include "runtime/LowLatency.h"
+#include "stats/StageProbe.h"
+#include "stats/TscClock.h"
+#include "store/TickStore.h"
 
-static bool keep_running = true;
+static std::atomic<bool> keep_running{true};
 void sigint_handler(int){ keep_running = false; }
 
-using steady_clock = std::chrono::steady_clock;
-using ns = std::chrono::nanoseconds;
+// --jitter-compare: the loopback probe (runtime/LowLatency.h) read blocking, then busy
+// polling, on the calling thread; one `JITTER <mode> kernel->user_us` line per mode
+static void print_jitter_compare(const LowLatencyConfig& ll) {
+    constexpr double PROBE_RATE_HZ = 10000.0;
+    for (bool busy : {false, true}) {
+        const char* prefix = busy ? "JITTER busy_poll" : "JITTER blocking";
+        LatencyHistogram h;
+        std::string err;
+        if (!sample_receive_jitter(busy, ll, ll.jitter_samples, PROBE_RATE_HZ, h, err)) {
+            std::cout << prefix << " FAILED " << err << "\n";
+            break;
+        }
+        print_histogram(std::cout, prefix, "kernel->user_us", h);
+    }
+    std::cout.flush();
+}
+
+// --shards: one SO_REUSEPORT socket, pinned thread and private engine per shard.
+// `base` carries the per-shard settings; cpu, log path and store dir are filled in per shard
+static int run_shards(size_t shards, const std::vector<int>& cpus, UdpSocketConfig sock_cfg, const EngineConfig& cfg,
+                      const ShardConfig& base, const LowLatencyConfig& ll, const std::string& effective_mode,
+                      SharedMetrics& metrics) {
+    const unsigned ncpu = std::max(1u, std::thread::hardware_concurrency());
+    // multicast reaches every socket bound to the port, SO_REUSEPORT or not, so groups are
+    // split instead: shard i joins groups i, i + shards, ... and only receives those
+    const std::vector<std::string> groups = sock_cfg.groups;
+    if (!groups.empty() && groups.size() < shards) {
+        std::cerr << "--shards=" << shards << " needs at least as many --multicast groups (" << groups.size() << ")\n";
+        return 1;
+    }
+    std::vector<std::unique_ptr<ReceiverShard>> pool;
+    bool busy_poll_ok = true;
+    std::string busy_poll_err;
+    for (size_t i = 0; i < shards; ++i) {
+        sock_cfg.groups.clear();
+        for (size_t g = i; g < groups.size(); g += shards) sock_cfg.groups.push_back(groups[g]);
+        int sock = open_udp_socket(sock_cfg);
+        if (sock < 0) return 1;
+        ShardConfig sc = base;
+        // one binary log per shard: <path>.<shard>
+        if (!base.signal_log_path.empty()) sc.signal_log_path = base.signal_log_path + "." + std::to_string(i);
+        // and one tick store per shard: <dir>.<shard>
+        if (!base.store.dir.empty()) sc.store.dir = base.store.dir + "." + std::to_string(i);
+        sc.cpu = cpus.empty() ? int(i % ncpu) : cpus[i % cpus.size()];
+        if (ll.busy_poll_us > 0 && !set_socket_busy_poll(sock, ll.busy_poll_us, busy_poll_err)) busy_poll_ok = false;
+        pool.emplace_back(new ReceiverShard(i, sock, cfg, sc));
+        if (MetricsSlot* m = metrics.slot(i)) {
+            std::snprintf(m->label, sizeof(m->label), "shard%zu", i);
+            pool.back()->set_metrics(m);
+        }
+    }
+    // pinning and SCHED_FIFO happen on the shard threads, which report refusals themselves
+    TuningReport report;
+    if (ll.busy_poll) report.add("receive", true, "busy-poll (MSG_DONTWAIT spin) on every shard");
+    if (ll.busy_poll_us > 0) {
+        report.add("SO_BUSY_POLL", busy_poll_ok, std::to_string(ll.busy_poll_us) + "us" + (busy_poll_ok ? "" : ": " + busy_poll_err));
+    }
+    apply_process_tuning(ll, report);
+    report.print(std::cout);
+    if (ll.jitter_samples > 0) print_jitter_compare(ll);
+    std::cout << "Listening UDP on port " << sock_cfg.port << " with " << shards << " SO_REUSEPORT shards, cpus=";
+    for (size_t i = 0; i < pool.size(); ++i) std::cout << (i ? "," : "") << pool[i]->cpu();
+    std::cout << "\n";
+    for (auto& s : pool) {
+        if (!s->start(keep_running)) {
+            keep_running = false;
+            return 1;
+        }
+    }
+    for (auto& s : pool) s->join();
 
-struct Stats {
-    std::vector<double> lat_recv_decision_us;
-    std::vector<double> lat_src_recv_us;
-    void push(double a, double b) {
-        lat_recv_decision_us.push_back(a);
-        lat_src_recv_us.push_back(b);
+    uint64_t total_datagrams = 0, total_ticks = 0, total_kernel_drops = 0, total_lost = 0;
+    for (auto& s : pool) {
+        const Engine& e = s->engine();
+        const std::string prefix = "STAT shard=" + std::to_string(s->id());
+        print_histogram(std::cout, prefix.c_str(), "recv->decision_us", e.stats().recv_decision_ns);
+        print_histogram(std::cout, prefix.c_str(), "src->recv_us", e.stats().src_recv_ns);
+        print_stage_stats(std::cout, prefix.c_str(), e.stats().stages);
+        const UdpIngest& in = s->ingest();
+        const uint64_t ticks = e.stats().recv_decision_ns.count();
+        std::cout << "STAT shard id=" << s->id() << " cpu=" << s->cpu() << (s->pinned() ? "" : "(unpinned)")
+                  << (s->realtime() ? " sched=fifo" : "")
+                  << " datagrams=" << in.datagrams() << " ticks=" << ticks << " decisions=" << s->decisions()
+                  << " syscalls=" << in.syscalls();
+        if (in.syscalls() > 0) std::cout << " avg_batch=" << double(in.datagrams()) / double(in.syscalls());
+        if (s->active_s() > 0.0) {
+            std::cout << " datagrams_per_s=" << std::fixed << std::setprecision(0)
+                      << double(in.datagrams()) / s->active_s() << std::defaultfloat << std::setprecision(6);
+        }
+        std::cout << " kernel_drops=" << s->kernel_drops() << " parse_errors=" << e.parse_counters().errors()
+                  << " symbol_overflow=" << e.symbols().overflow();
+        if (in.busy_poll()) std::cout << " empty_polls=" << in.empty_polls();
+        if (s->echo().enabled()) std::cout << " echo_sent=" << s->echo().sent() << " echo_errors=" << s->echo().errors();
+        if (const TickStore* ts = s->tick_store()) std::cout << " store_rows=" << ts->rows() << " store_drops=" << ts->drops() << " store_lost=" << ts->lost();
+        std::cout << " log_drops=" << s->signal_log().drops() << "\n";
+        if (in.mode() != UdpIngest::TimestampMode::User) {
+            print_histogram(std::cout, prefix.c_str(), "kernel->user_us", in.kernel_to_user_ns());
+        }
+        total_datagrams += in.datagrams();
+        total_ticks += ticks;
+        total_kernel_drops += s->kernel_drops();
+        total_lost += s->signal_log().drops();
     }
-};
+    std::cout << "STAT shards count=" << pool.size() << " datagrams=" << total_datagrams << " ticks=" << total_ticks
+              << " kernel_drops=" << total_kernel_drops << " lost=" << total_lost << "\n";
+    std::cout << "SUMMARY Predictor mode=" << effective_mode << "\n";
+    metrics.close();
+    return 0;
+}
 
 int main(int argc, char** argv) {
     signal(SIGINT, sigint_handler);
@@ -40,6 +153,65 @@ int main(int argc, char** argv) {
     int port = 9000;
     // parse minimal args: --mode=cpu|gpu and optional port positional or --port=<n>
     Predictor::Mode requested_mode = Predictor::Mode::CPU;
+    // --ingest=user|kernel|timestamping selects where recv_ts comes from; --batch=<n> datagrams per syscall
+    // (default user, kernel under --low-latency so its receive jitter is always reported)
+    UdpIngest::TimestampMode ingest_mode = UdpIngest::TimestampMode::User;
+    bool ingest_given = false;
+    size_t ingest_batch = 64;
+    // --max-symbols=<n> capacity of the per-symbol state table
+    size_t max_symbols = 4096;
+    // L2 book geometry and OFI depth: --tick-size=<px> --book-depth=<ticks> --ofi-levels=<n>
+    double tick_size = 0.01;
+    size_t book_depth = 1024;
+    size_t ofi_levels = 1;
+    // --pipeline: receive / compute / emit on three threads joined by SPSC rings of --ring=<n> slots
+    bool pipeline = false;
+    // signals go through an async log: text to stdout, or raw records to --signal-log=<path>
+    std::string signal_log_path;
+    size_t log_ring = 65536;
+    // --report-interval=<sec> period of INTERVAL latency percentile lines (0 = off)
+    double report_interval = 10.0;
+    size_t ring_slots = 65536;
+    // --record=<path> append every received datagram to a capture file;
+    // --replay=<path> feed a capture instead of the socket, --replay-speed=<x> (0 = as fast as possible)
+    std::string record_path;
+    std::string replay_path;
+    double replay_speed = 0.0;
+    // --bank=<path> extra alpha/threshold pairs evaluated on every tick (see PredictorBank.h)
+    std::string bank_path;
+    // sequencing by Tick::seq before OFI: --reorder-window=<n> early ticks held (0 = off),
+    // --reorder-timeout-us=<n> how long a gap may stay open before its ticks are given up;
+    // well above a scheduler slice, so a publisher thread that was preempted is not a loss
+    size_t reorder_window = 0;
+    double reorder_timeout_us = 50000.0;
+    // --multicast=<group>[,<group>...] joined on --iface=<name|addr>; --rcvbuf=<bytes> socket buffer
+    UdpSocketConfig sock_cfg;
+    // --shards=<n> SO_REUSEPORT sockets, each with its own receiver thread and state,
+    // pinned to --shard-cpus=<c0,c1,...> (default shard i -> cpu i mod #cpus)
+    size_t shards = 1;
+    std::vector<int> shard_cpus;
+    // --low-latency: busy-poll receive + mlockall; --cpu=<n> pins the receive thread,
+    // --busy-poll-us=<n> sets SO_BUSY_POLL, --sched-fifo=<prio> requests SCHED_FIFO (see runtime/LowLatency.h);
+    // --jitter-compare[=<n>] samples blocking vs busy-poll receive jitter at startup, <n> datagrams each
+    LowLatencyConfig ll;
+    // --predictor=runtime|double|float|fixed per-tick EWMA path (see predictor/StaticPredictor.h)
+    PredictorKind predictor_kind = PredictorKind::Runtime;
+    // --features: multi-horizon OFI features per tick (--feature-capacity=<n> ring entries per symbol);
+    // --feature-weights=<name>:<w>,... feeds their weighted sum to the predictor instead of raw OFI
+    bool features = false;
+    FeatureConfig feature_cfg;
+    std::vector<std::pair<std::string, double>> feature_weights;
+    // --metrics[=<name>]: live counters in POSIX shared memory for flow_imbalance_stat (see metrics/SharedMetrics.h)
+    std::string metrics_name;
+    // --echo=<ipv4>:<port> ack every --echo-every=<n>-th seq back to flow_imbalance_loadgen (see ingest/Echo.h)
+    std::string echo_dest;
+    uint32_t echo_every = 100;
+    // --store=<dir> every tick's seq/timestamps/price/size/OFI/EWMA/action in columnar segments of
+    // --store-segment-mb=<n> MiB (see store/TickStore.h); its ring is --log-ring slots
+    TickStoreConfig store_cfg;
+    // --clock=tsc|gettime interval clock for the tick path (see stats/TscClock.h); tsc falls back
+    // to clock_gettime without an invariant TSC
+    bool tsc_clock = true;
     for (int i = 1; i < argc; ++i) {
         std::string a(argv[i]);
         if (a.rfind("--mode=", 0) == 0) {
@@ -48,6 +220,127 @@ int main(int argc, char** argv) {
         } else if (a == "-m" && i + 1 < argc) {
             std::string m(argv[++i]);
             if (m == "gpu" || m == "GPU" || m == "Gpu") requested_mode = Predictor::Mode::GPU;
+        } else if (a.rfind("--ingest=", 0) == 0) {
+            std::string m = a.substr(9);
+            if (m == "kernel") ingest_mode = UdpIngest::TimestampMode::KernelNs;
+            else if (m == "timestamping") ingest_mode = UdpIngest::TimestampMode::KernelTimestamping;
+            else ingest_mode = UdpIngest::TimestampMode::User;
+            ingest_given = true;
+        } else if (a.rfind("--batch=", 0) == 0) {
+            int b = std::atoi(a.substr(8).c_str());
+            if (b > 0) ingest_batch = size_t(b);
+        } else if (a.rfind("--max-symbols=", 0) == 0) {
+            int m = std::atoi(a.substr(14).c_str());
+            if (m > 0) max_symbols = size_t(m);
+        } else if (a.rfind("--tick-size=", 0) == 0) {
+            double t = std::atof(a.substr(12).c_str());
+            if (t > 0.0) tick_size = t;
+        } else if (a.rfind("--book-depth=", 0) == 0) {
+            int d = std::atoi(a.substr(13).c_str());
+            if (d > 0) book_depth = size_t(d);
+        } else if (a.rfind("--ofi-levels=", 0) == 0) {
+            int l = std::atoi(a.substr(13).c_str());
+            if (l > 0) ofi_levels = size_t(l);
+        } else if (a == "--pipeline") {
+            pipeline = true;
+        } else if (a.rfind("--ring=", 0) == 0) {
+            int r = std::atoi(a.substr(7).c_str());
+            if (r > 0) ring_slots = size_t(r);
+        } else if (a.rfind("--report-interval=", 0) == 0) {
+            double r = std::atof(a.substr(18).c_str());
+            if (r >= 0.0) report_interval = r;
+        } else if (a.rfind("--signal-log=", 0) == 0) {
+            signal_log_path = a.substr(13);
+        } else if (a.rfind("--log-ring=", 0) == 0) {
+            int r = std::atoi(a.substr(11).c_str());
+            if (r > 0) log_ring = size_t(r);
+        } else if (a.rfind("--record=", 0) == 0) {
+            record_path = a.substr(9);
+        } else if (a.rfind("--replay=", 0) == 0) {
+            replay_path = a.substr(9);
+        } else if (a.rfind("--replay-speed=", 0) == 0) {
+            double r = std::atof(a.substr(15).c_str());
+            if (r >= 0.0) replay_speed = r;
+        } else if (a.rfind("--bank=", 0) == 0) {
+            bank_path = a.substr(7);
+        } else if (a.rfind("--reorder-window=", 0) == 0) {
+            int w = std::atoi(a.substr(17).c_str());
+            if (w >= 0) reorder_window = size_t(w);
+        } else if (a.rfind("--reorder-timeout-us=", 0) == 0) {
+            double t = std::atof(a.substr(21).c_str());
+            if (t >= 0.0) reorder_timeout_us = t;
+        } else if (a.rfind("--multicast=", 0) == 0) {
+            std::stringstream groups(a.substr(12));
+            for (std::string g; std::getline(groups, g, ',');) {
+                if (!g.empty()) sock_cfg.groups.push_back(g);
+            }
+        } else if (a.rfind("--iface=", 0) == 0) {
+            sock_cfg.iface = a.substr(8);
+        } else if (a.rfind("--rcvbuf=", 0) == 0) {
+            int b = std::atoi(a.substr(9).c_str());
+            if (b > 0) sock_cfg.rcvbuf = b;
+        } else if (a.rfind("--shards=", 0) == 0) {
+            int n = std::atoi(a.substr(9).c_str());
+            if (n > 0) shards = size_t(n);
+        } else if (a.rfind("--shard-cpus=", 0) == 0) {
+            std::stringstream cpus(a.substr(13));
+            for (std::string c; std::getline(cpus, c, ',');) {
+                if (!c.empty()) shard_cpus.push_back(std::atoi(c.c_str()));
+            }
+        } else if (a.rfind("--predictor=", 0) == 0) {
+            std::string k = a.substr(12);
+            if (k == "double") predictor_kind = PredictorKind::StaticDouble;
+            else if (k == "float") predictor_kind = PredictorKind::StaticFloat;
+            else if (k == "fixed") predictor_kind = PredictorKind::StaticFixed;
+            else predictor_kind = PredictorKind::Runtime;
+        } else if (a == "--features") {
+            features = true;
+        } else if (a.rfind("--feature-capacity=", 0) == 0) {
+            int c = std::atoi(a.substr(19).c_str());
+            if (c > 0) feature_cfg.capacity = size_t(c);
+        } else if (a.rfind("--feature-weights=", 0) == 0) {
+            std::stringstream list(a.substr(18));
+            for (std::string item; std::getline(list, item, ',');) {
+                size_t colon = item.rfind(':');
+                if (colon == std::string::npos) {
+                    std::cerr << "--feature-weights: expected <name>:<weight>, got " << item << "\n";
+                    return 1;
+                }
+                feature_weights.emplace_back(item.substr(0, colon), std::atof(item.substr(colon + 1).c_str()));
+            }
+            features = true;
+        } else if (a == "--metrics") {
+            metrics_name = METRICS_DEFAULT_NAME;
+        } else if (a.rfind("--metrics=", 0) == 0) {
+            metrics_name = metrics_shm_name(a.substr(10));
+        } else if (a.rfind("--echo=", 0) == 0) {
+            echo_dest = a.substr(7);
+        } else if (a.rfind("--echo-every=", 0) == 0) {
+            int n = std::atoi(a.substr(13).c_str());
+            if (n > 0) echo_every = uint32_t(n);
+        } else if (a.rfind("--store=", 0) == 0) {
+            store_cfg.dir = a.substr(8);
+        } else if (a.rfind("--store-segment-mb=", 0) == 0) {
+            int mb = std::atoi(a.substr(19).c_str());
+            if (mb > 0) store_cfg.segment_bytes = size_t(mb) << 20;
+        } else if (a == "--clock=tsc" || a == "--clock=gettime") {
+            tsc_clock = a == "--clock=tsc";
+        } else if (a == "--low-latency") {
+            ll.busy_poll = true;
+            ll.lock_memory = true;
+        } else if (a == "--jitter-compare") {
+            ll.jitter_samples = 5000;
+        } else if (a.rfind("--jitter-compare=", 0) == 0) {
+            long n = std::atol(a.substr(17).c_str());
+            if (n >= 0) ll.jitter_samples = size_t(n);
+        } else if (a.rfind("--cpu=", 0) == 0) {
+            ll.cpu = std::atoi(a.substr(6).c_str());
+        } else if (a.rfind("--busy-poll-us=", 0) == 0) {
+            int us = std::atoi(a.substr(15).c_str());
+            if (us >= 0) ll.busy_poll_us = us;
+        } else if (a.rfind("--sched-fifo=", 0) == 0) {
+            int p = std::atoi(a.substr(13).c_str());
+            if (p >= 0 && p <= 99) ll.fifo_priority = p;
         } else if (a.rfind("--port=", 0) == 0) {
             port = std::atoi(a.substr(7).c_str());
         } else {
@@ -58,124 +351,451 @@ int main(int argc, char** argv) {
         }
     }
 
-    // Setup UDP socket
-    int sock = socket(AF_INET, SOCK_DGRAM, 0);
-    if (sock < 0) { perror("socket"); return 1; }
-    sockaddr_in addr;
-    std::memset(&addr, 0, sizeof(addr));
-    addr.sin_family = AF_INET;
-    addr.sin_addr.s_addr = INADDR_ANY;
-    addr.sin_port = htons(port);
-    if (bind(sock, (sockaddr*)&addr, sizeof(addr)) < 0) { perror("bind"); return 1; }
+    if (ll.busy_poll && !ingest_given) ingest_mode = UdpIngest::TimestampMode::KernelNs;
+    const bool replay = !replay_path.empty();
+    const bool sharded = shards > 1;
+    if (sharded && (replay || pipeline || !record_path.empty())) {
+        std::cerr << "--shards cannot be combined with --replay, --record or --pipeline\n";
+        return 1;
+    }
+    if (sharded && reorder_window > 0) {
+        // SO_REUSEPORT hashes source 4-tuples, so one publisher's seq space can be split over shards
+        std::cerr << "--shards cannot be combined with --reorder-window\n";
+        return 1;
+    }
+    sock_cfg.port = port;
+    sock_cfg.reuse_port = sharded;
+    CaptureReader capture_in;
+    int sock = -1;
+    if (replay) {
+        if (!capture_in.open(replay_path)) return 1;
+        std::cout << "Replaying " << replay_path << " (" << capture_in.file_size() << " bytes, ts="
+                  << UdpIngest::mode_name(UdpIngest::TimestampMode(capture_in.ts_mode())) << ") at ";
+        if (replay_speed > 0.0) std::cout << replay_speed << "x original pacing\n";
+        else std::cout << "full speed\n";
+    } else if (!sharded) {
+        // Setup UDP socket
+        sock = open_udp_socket(sock_cfg);
+        if (sock < 0) return 1;
 
-    std::cout << "Listening UDP on port " << port << "\n";
+        std::cout << "Listening UDP on port " << port << "\n";
+    }
+    if (!sock_cfg.groups.empty() && !replay) {
+        std::cout << "Multicast:";
+        for (const std::string& g : sock_cfg.groups) std::cout << " " << g;
+        std::cout << " iface=" << (sock_cfg.iface.empty() ? "default" : sock_cfg.iface) << "\n";
+    }
 
-    OrderBook ob;
-    Predictor pred(0.15, 40.0, requested_mode);
+    Predictor pred(ENGINE_ALPHA, ENGINE_THRESHOLD, requested_mode);
     // Print requested/effective mode
     std::string effective_mode = "CPU";
     if (pred.get_mode() == Predictor::Mode::GPU && pred.gpu_available()) effective_mode = "GPU";
     else if (pred.get_mode() == Predictor::Mode::GPU && !pred.gpu_available()) effective_mode = "GPU(requested->CPU fallback)";
     std::cout << "Predictor mode: " << effective_mode << "\n";
-    Stats stats;
+    // before any engine thread exists: every thread reads the same source
+    if (tsc_clock) TscClock::calibrate();
+    else TscClock::use_clock_gettime();
+    std::cout << "Clock: " << TscClock::source();
+    if (TscClock::tsc()) std::cout << " " << std::fixed << std::setprecision(3) << TscClock::ticks_per_s() / 1e9 << " GHz";
+    std::cout << std::fixed << std::setprecision(1) << ", read " << TscClock::read_ns() << " ns" << std::defaultfloat
+              << std::setprecision(6);
+    if (FLOW_IMBALANCE_STAGE_PROBES) std::cout << ", stage probes on";
+    std::cout << "\n";
+    if (predictor_kind != PredictorKind::Runtime) {
+        std::cout << "Predictor: " << predictor_kind_name(predictor_kind) << " (compile-time alpha=" << ENGINE_ALPHA
+                  << " threshold=" << ENGINE_THRESHOLD << ")\n";
+    }
 
-    // minimal buffer for incoming UDP line
+    // batched receive: preallocated datagram buffers drained via recvmmsg
     const int BUF_SZ = 2048;
-    char buf[BUF_SZ];
-
-    // For OFI we need the previous tick
-    bool have_prev = false;
-    Tick prev_tick;
-
-    while (keep_running) {
-        sockaddr_in src;
-        socklen_t srclen = sizeof(src);
-        ssize_t n = recvfrom(sock, buf, BUF_SZ - 1, 0, (sockaddr*)&src, &srclen);
-        if (n <= 0) continue;
-        buf[n] = '\0';
-        // host recv timestamp
-        auto recv_tp = std::chrono::system_clock::now();
-        double recv_ts = std::chrono::duration_cast<std::chrono::duration<double>>(recv_tp.time_since_epoch()).count();
-
-        // parse CSV: seq,src_ts,price,size
-        uint64_t seq = 0;
-        double src_ts = 0.0;
-        double price = 0.0;
-        uint32_t size = 0;
-        // use sscanf for speed (robust enough for this format)
-        int matched = std::sscanf(buf, "%lu,%lf,%lf,%u", &seq, &src_ts, &price, &size);
-        if (matched < 4) {
-            // try alternative parse with long long on systems where %llu isn't right
-            unsigned long long tmpseq;
-            int m2 = std::sscanf(buf, "%llu,%lf,%lf,%u", &tmpseq, &src_ts, &price, &size);
-            if (m2 >= 4) seq = tmpseq;
-            else continue;
-        }
-
-        Tick tick;
-        tick.seq = seq;
-        tick.src_ts = src_ts;
-        tick.recv_ts = recv_ts;
-        tick.price = price;
-        tick.size = size;
-
-        // apply to simple orderbook (store latest)
-        // compute using prev tick
-        double ofi = 0.0;
-        if (have_prev) {
-            ofi = compute_ofi(prev_tick, tick);
-        }
-        prev_tick = tick;
-        have_prev = true;
-        ob.apply_tick(tick);
-
-        // predictor timing
-        auto dec_start = steady_clock::now();
-        int action = pred.process_sample(ofi);
-        auto dec_end = steady_clock::now();
-
-        double recv_to_decision_us = std::chrono::duration_cast<ns>(dec_end - dec_start).count() / 1000.0;
-        double src_to_recv_us = (tick.recv_ts - tick.src_ts) * 1e6;
-
-        stats.push(recv_to_decision_us, src_to_recv_us);
-
-        // emit signal (print for now)
-        if (action != 0) {
-            const char* act = action > 0 ? "BUY" : "SELL";
-            double ewma = pred.get_ewma();
-            std::cout << "[" << seq << "] " << act << " ewma=" << std::fixed << std::setprecision(2) << ewma
-                      << " ofi=" << ofi
-                      << " recv->dec(us)=" << recv_to_decision_us
-                      << " src->recv(us)=" << src_to_recv_us
-                      << "\n";
-        }
-
-        // optionally: throttle printing to avoid slowing everything; MVP leaves as-is
-
-    }
-
-    // Summary stats
-    auto print_stats = [](const std::vector<double>& v, const char* name){
-        if (v.empty()) return;
-        std::vector<double> copy = v;
-        std::sort(copy.begin(), copy.end());
-        auto p = [&](double q){
-            int idx = int(q * (copy.size()-1));
-            return copy[idx];
-        };
-        std::cout << "STAT " << name << " count=" << copy.size()
-                  << " p50=" << p(0.5)
-                  << " p90=" << p(0.9)
-                  << " p99=" << p(0.99)
-                  << " mean=" << (std::accumulate(copy.begin(), copy.end(), 0.0)/copy.size())
-                  << "\n";
+    std::unique_ptr<UdpIngest> ingest;
+    CaptureWriter capture_out;
+    if (!replay && !sharded) {
+        ingest.reset(new UdpIngest(sock, ingest_batch, BUF_SZ - 1, ingest_mode));
+        ingest->init();
+        ingest->set_busy_poll(ll.busy_poll);
+        std::cout << "Ingest: batch=" << ingest->batch_size() << " ts=" << UdpIngest::mode_name(ingest->mode()) << "\n";
+        if (reorder_window > 0 && !pipeline && !ll.busy_poll) {
+            // wake up without traffic so held ticks still time out (the pipeline polls from compute instead)
+            set_receive_timeout(sock, reorder_timeout_us / 1e6);
+        }
+        if (!record_path.empty()) {
+            if (!capture_out.open(record_path, uint32_t(ingest->mode()))) return 1;
+            std::cout << "Recording datagrams -> " << record_path << "\n";
+        }
+    }
+
+    EngineConfig cfg;
+    cfg.alpha = pred.get_alpha();
+    cfg.threshold = pred.get_threshold();
+    cfg.max_symbols = max_symbols;
+    cfg.tick_size = tick_size;
+    cfg.book_depth = book_depth;
+    cfg.ofi_levels = ofi_levels;
+    cfg.report_interval_s = report_interval;
+    cfg.predictor = predictor_kind;
+    cfg.features = features;
+    cfg.feature_cfg = feature_cfg;
+    cfg.feature_weights = feature_weights;
+    if (features) {
+        // layout only: no symbols, so nothing is allocated
+        FeatureEngine layout(feature_cfg, 0);
+        for (const auto& fw : feature_weights) {
+            if (layout.index(fw.first) < 0) {
+                std::cerr << "--feature-weights: unknown feature " << fw.first << "\n";
+                return 1;
+            }
+        }
+        std::cout << "Features: " << layout.size() << " per tick, ring=" << layout.capacity() << " per symbol:";
+        for (const std::string& n : layout.names()) std::cout << " " << n;
+        std::cout << "\n";
+        if (!feature_weights.empty()) {
+            std::cout << "Predictor input: ";
+            for (size_t i = 0; i < feature_weights.size(); ++i) {
+                std::cout << (i ? " + " : "") << feature_weights[i].second << "*" << feature_weights[i].first;
+            }
+            std::cout << "\n";
+        }
+    }
+    if (!bank_path.empty()) {
+        std::string err;
+        if (!load_bank_configs(bank_path, cfg.bank, err)) {
+            std::cerr << "bank: " << err << "\n";
+            return 1;
+        }
+    }
+    SharedMetrics metrics;
+    if (!metrics_name.empty()) {
+        std::string err;
+        if (!metrics.create(metrics_name, sharded ? shards : 1, err)) {
+            std::cerr << "metrics: " << err << "\n";
+            return 1;
+        }
+        std::cout << "Metrics: shared memory " << metrics_name << " (" << metrics.slots() << " slots)\n";
+    }
+    if (sharded) {
+        ShardConfig sc;
+        sc.batch = ingest_batch;
+        sc.ts_mode = ingest_mode;
+        sc.log_ring = log_ring;
+        sc.signal_log_path = signal_log_path;
+        sc.busy_poll = ll.busy_poll;
+        sc.fifo_priority = ll.fifo_priority;
+        sc.echo_dest = echo_dest;
+        sc.echo_every = echo_every;
+        sc.store = store_cfg;
+        sc.store.ring = log_ring;
+        std::vector<int> cpus = shard_cpus;
+        if (cpus.empty() && ll.cpu >= 0) cpus.push_back(ll.cpu);
+        return run_shards(shards, cpus, sock_cfg, cfg, sc, ll, effective_mode, metrics);
+    }
+    Engine engine(cfg);
+    MetricsSlot* mslot = metrics.slot(0);
+    if (mslot) {
+        std::snprintf(mslot->label, sizeof(mslot->label), "%s", pipeline ? "pipeline" : "engine");
+        engine.set_metrics(mslot);
+    }
+    if (const PredictorBank* bank = engine.bank()) {
+        std::cout << "Predictor bank: " << bank->size() << " configs from " << bank_path
+                  << " (kernel=" << batch_kernel_name(bank->kernel()) << ")\n";
+    }
+
+    // BUY/SELL records are copied into the log's ring; formatting/IO happens on its thread
+    SignalLog signal_log(log_ring, engine.symbols());
+    if (!signal_log_path.empty()) {
+        if (!signal_log.open_binary(signal_log_path)) return 1;
+        std::cout << "Signal log: binary -> " << signal_log_path << "\n";
+    }
+    signal_log.start();
+
+    // filled from the thread calling Engine::process, written by its own thread
+    std::unique_ptr<TickStore> tick_store;
+    if (!store_cfg.dir.empty()) {
+        store_cfg.ring = log_ring;
+        tick_store.reset(new TickStore(store_cfg, engine.symbols()));
+        std::string err;
+        if (!tick_store->open(err)) {
+            std::cerr << "store: " << err << "\n";
+            return 1;
+        }
+        tick_store->start();
+        engine.set_tick_store(tick_store.get(), replay);
+        std::cout << "Store: every tick -> " << store_cfg.dir << " (segments of " << (store_cfg.segment_bytes >> 20)
+                  << " MiB)\n";
+    }
+
+    // acks are sent from the thread calling Engine::process
+    EchoSender echo;
+    if (!echo_dest.empty()) {
+        if (!echo.open(echo_dest, echo_every)) return 1;
+        std::cout << "Echo: acking every " << echo_every << "th seq -> " << echo_dest << "\n";
+    }
+
+    // runs on whichever thread calls Engine::process; a gap it gives up resets
+    // the per-symbol previous trade before the next tick is processed
+    const bool sequencing = reorder_window > 0;
+    Sequencer sequencer(sequencing ? reorder_window : 2, reorder_timeout_us / 1e6);
+    auto on_gap = [&] { engine.resync(); };
+    // decisions -> signal log, acks -> echo (replay never sheds: a full log ring waits for the writer)
+    engine.set_output(&signal_log, &echo, replay);
+    auto deliver = [&](const Tick& tick) { engine.deliver(tick); };
+    if (sequencing) {
+        std::cout << "Sequencer: window=" << sequencer.window() << " timeout_us=" << reorder_timeout_us << "\n";
+    }
+    auto wall_now = [] {
+        return std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+    };
+
+    // pipeline ring (unused in the default single-threaded mode)
+    SpscRing<Tick> tick_ring(pipeline ? ring_slots : 2);
+
+    uint64_t replayed = 0;
+    double replay_elapsed_s = 0.0;
+
+    // live metrics besides what Engine::process publishes per tick. Each runs on the thread
+    // that owns the values it reads: receive side after every batch, process side after every
+    // batch (single thread) or every 256 ticks and when idle (pipeline compute thread)
+    int64_t next_drop_sample_ns = 0;
+    auto publish_receive_metrics = [&] {
+        metric_set(mslot->datagrams, replay ? replayed : ingest->datagrams());
+        metric_set(mslot->parse_errors, engine.parse_counters().errors());
+        if (pipeline) {
+            metric_set(mslot->tick_ring_drops, tick_ring.drops());
+            metric_set(mslot->tick_ring_depth, tick_ring.size());
+        }
+        if (!ingest) return;
+        // SO_MEMINFO is a syscall: sampled, not per batch
+        const int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                   std::chrono::steady_clock::now().time_since_epoch()).count();
+        if (now_ns >= next_drop_sample_ns) {
+            metric_set(mslot->kernel_drops, ingest->kernel_drops());
+            next_drop_sample_ns = now_ns + MetricsSlot::LATENCY_INTERVAL_NS;
+        }
+    };
+    auto publish_process_metrics = [&] {
+        metric_set(mslot->seq_dropped, sequencer.counters().dropped);
+        metric_set(mslot->seq_held, sequencer.held());
+        metric_set(mslot->log_drops, signal_log.drops());
+        metric_set(mslot->log_ring_depth, signal_log.depth());
     };
+    auto publish_batch_metrics = [&] {
+        if (!mslot) return;
+        publish_receive_metrics();
+        if (!pipeline) publish_process_metrics();
+    };
+
+    // the receive stage: live socket (optionally recorded) or a capture replay.
+    // replay feeds the same bytes and recv_ts through Engine::decode; with a
+    // speed > 0 each datagram is held back until its original offset / speed
+    // on_batch() runs after every live receive call, including empty ones
+    auto receive = [&](auto&& on_tick, auto&& on_batch) {
+        if (!replay) {
+            while (keep_running) {
+                int got = ingest->receive_batch();
+                for (int k = 0; k < got; ++k) {
+                    if (capture_out.is_open()) capture_out.append(ingest->data(k), ingest->length(k), ingest->recv_ts(k));
+                    engine.decode(ingest->data(k), ingest->length(k), ingest->recv_ts(k), on_tick);
+                }
+                on_batch();
+                publish_batch_metrics();
+            }
+            return;
+        }
+        const char* data;
+        size_t len;
+        double ts;
+        double first_ts = 0.0;
+        auto start = std::chrono::steady_clock::now();
+        while (keep_running && capture_in.next(data, len, ts)) {
+            if (replay_speed > 0.0) {
+                if (replayed == 0) first_ts = ts;
+                auto due = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                       std::chrono::duration<double>((ts - first_ts) / replay_speed));
+                // sleep through long gaps, spin the last stretch so pacing stays tight
+                auto now = std::chrono::steady_clock::now();
+                if (due - now > std::chrono::microseconds(200)) std::this_thread::sleep_until(due - std::chrono::microseconds(100));
+                while (std::chrono::steady_clock::now() < due) {}
+            }
+            engine.decode(data, len, ts, on_tick);
+            if ((++replayed & 255) == 0) publish_batch_metrics();
+        }
+        publish_batch_metrics();
+        replay_elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    // the receive thread is the main thread in both modes; it is tuned once every other
+    // thread exists, so none of them inherits its pinning or SCHED_FIFO
+    TuningReport tuning;
+    if (ingest) apply_socket_tuning(sock, ll, tuning);
+    auto tune_receive_thread = [&] {
+        apply_thread_tuning(ll, tuning);
+        apply_process_tuning(ll, tuning);
+        tuning.print(std::cout);
+        if (ingest && ll.jitter_samples > 0) print_jitter_compare(ll);
+        std::cout.flush();
+    };
+
+    if (!pipeline) {
+        // single thread: receive, parse and compute inline; no locks, no queues besides the log
+        auto on_tick = [&](const Tick& tick) {
+            if (sequencing) sequencer.push(tick, tick.recv_ts, deliver, on_gap);
+            else deliver(tick);
+        };
+        auto on_batch = [&] {
+            if (sequencer.held() > 0) sequencer.poll(wall_now(), deliver, on_gap);
+        };
+        tune_receive_thread();
+        receive(on_tick, on_batch);
+        sequencer.flush(deliver, on_gap);
+        if (mslot) publish_process_metrics();
+    } else {
+        std::cout << "Pipeline: recv -> compute -> log, ring slots=" << tick_ring.capacity() << "\n";
+        // compute exits once receive is done and the tick ring is drained;
+        // the signal log's writer thread is the emit stage
+        std::atomic<bool> recv_done{false};
+
+        // names are interned by the receive thread before the tick is published,
+        // so the log thread can read symbols by id once a decision reaches it
+        std::thread compute_thread([&] {
+            Tick tick;
+            auto offer = [&](const Tick& t) {
+                if (sequencing) sequencer.push(t, t.recv_ts, deliver, on_gap);
+                else deliver(t);
+            };
+            uint64_t popped = 0;
+            for (;;) {
+                if (tick_ring.try_pop(tick)) {
+                    offer(tick);
+                    if (mslot && (++popped & 255) == 0) publish_process_metrics();
+                } else if (recv_done.load(std::memory_order_acquire)) {
+                    if (!tick_ring.try_pop(tick)) break;
+                    offer(tick);
+                } else {
+                    // live gaps time out against the wall clock while the ring is empty
+                    if (!replay && sequencer.held() > 0) sequencer.poll(wall_now(), deliver, on_gap);
+                    if (mslot) publish_process_metrics();
+                    std::this_thread::yield();
+                }
+            }
+            sequencer.flush(deliver, on_gap);
+            if (mslot) publish_process_metrics();
+        });
 
-    print_stats(stats.lat_recv_decision_us, "recv->decision_us");
-    print_stats(stats.lat_src_recv_us, "src->recv_us");
+        // receive stage runs on the main thread; full ring -> tick is dropped and counted
+        // (replay waits for the compute thread instead)
+        auto on_tick = [&](const Tick& tick) {
+            if (replay) tick_ring.push(tick);
+            else tick_ring.try_push(tick);
+        };
+        tune_receive_thread();
+        receive(on_tick, [] {});
+        recv_done.store(true, std::memory_order_release);
+        compute_thread.join();
+    }
+    signal_log.stop();
+    if (tick_store) tick_store->stop();
+    capture_out.close();
+
+    // Summary stats (cumulative over the run)
+    print_histogram(std::cout, "STAT", "recv->decision_us", engine.stats().recv_decision_ns);
+    print_histogram(std::cout, "STAT", "src->recv_us", engine.stats().src_recv_ns);
+    print_stage_stats(std::cout, "STAT", engine.stats().stages);
+
+    if (const PredictorBank* bank = engine.bank()) {
+        print_histogram(std::cout, "STAT", "bank_update_us", engine.stats().bank_update_ns);
+        for (size_t i = 0; i < bank->size(); ++i) {
+            std::cout << "STAT bank_config id=" << i << " alpha=" << bank->config(i).alpha
+                      << " threshold=" << bank->config(i).threshold << " buy_ticks=" << bank->buy_ticks(i)
+                      << " sell_ticks=" << bank->sell_ticks(i) << "\n";
+        }
+    }
+
+    if (const FeatureEngine* fe = engine.features()) {
+        print_histogram(std::cout, "STAT", "feature_update_us", engine.stats().feature_update_ns);
+        std::cout << "STAT features size=" << fe->size() << " capacity=" << fe->capacity()
+                  << " overflow_evictions=" << fe->overflow_evictions() << "\n";
+        // the last tick's vector, for a quick look at scales when choosing weights
+        if (const double* f = engine.last_features()) {
+            std::cout << "STAT features last";
+            for (size_t i = 0; i < fe->size(); ++i) std::cout << " " << fe->names()[i] << "=" << f[i];
+            std::cout << "\n";
+        }
+    }
+
+    const ParseCounters& pc = engine.parse_counters();
+    std::cout << "STAT parse ok=" << pc.ok << " errors=" << pc.errors()
+              << " empty=" << pc.empty << " fields=" << pc.fields
+              << " bad_seq=" << pc.bad_seq << " bad_src_ts=" << pc.bad_src_ts
+              << " bad_price=" << pc.bad_price << " bad_size=" << pc.bad_size
+              << " bad_symbol=" << pc.bad_symbol << " bad_binary=" << pc.bad_binary << "\n";
+    const SymbolTable& symbols = engine.symbols();
+    std::cout << "STAT symbols count=" << symbols.size() << " capacity=" << symbols.capacity()
+              << " overflow_dropped=" << symbols.overflow() << "\n";
+    uint64_t book_oor = 0, book_recenters = 0, book_bad_price = 0;
+    for (uint32_t id = 0; id < symbols.size(); ++id) {
+        book_oor += engine.store().book(id).out_of_range();
+        book_recenters += engine.store().book(id).recenters();
+        book_bad_price += engine.store().book(id).bad_price();
+    }
+    std::cout << "STAT book out_of_range=" << book_oor << " recenters=" << book_recenters
+              << " bad_price=" << book_bad_price << " gap_resets=" << engine.store().book_resets()
+              << " rebuild_ticks=" << engine.store().rebuild_ticks() << "\n";
+
+    if (sequencing) {
+        const SequencerCounters& sc = sequencer.counters();
+        std::cout << "STAT sequencer in_order=" << sc.in_order << " reordered=" << sc.reordered
+                  << " duplicates=" << sc.duplicates << " late=" << sc.late << " gaps=" << sc.gaps
+                  << " dropped=" << sc.dropped << " resets=" << sc.resets << " max_held=" << sc.max_held << "\n";
+    }
+    if (echo.enabled()) {
+        std::cout << "STAT echo every=" << echo_every << " sent=" << echo.sent() << " errors=" << echo.errors() << "\n";
+    }
+    if (tick_store) {
+        std::cout << "STAT store dir=" << tick_store->dir() << " rows=" << tick_store->rows()
+                  << " segments=" << tick_store->segments() << " bytes=" << tick_store->bytes();
+        if (tick_store->rows() > 0) std::cout << " bytes_per_row=" << double(tick_store->bytes()) / double(tick_store->rows());
+        std::cout << " ring=" << tick_store->capacity() << " high_water=" << tick_store->high_water()
+                  << " drops=" << tick_store->drops() << " lost=" << tick_store->lost() << "\n";
+    }
+    if (pipeline) {
+        std::cout << "STAT pipeline tick_ring cap=" << tick_ring.capacity() << " high_water=" << tick_ring.high_water()
+                  << " drops=" << tick_ring.drops() << "\n";
+    }
+    std::cout << "STAT signal_log " << (signal_log.binary() ? "binary" : "text")
+              << " written=" << signal_log.written() << " ring=" << signal_log.capacity()
+              << " high_water=" << signal_log.high_water() << " drops=" << signal_log.drops()
+              << " decisions=" << engine.decisions() << "\n";
+
+    if (replay) {
+        uint64_t ticks = engine.stats().recv_decision_ns.count();
+        std::cout << "STAT replay datagrams=" << replayed << " ticks=" << ticks << " elapsed_s=" << replay_elapsed_s;
+        if (replay_elapsed_s > 0.0) std::cout << " ticks_per_s=" << std::fixed << std::setprecision(0)
+                                              << double(ticks) / replay_elapsed_s << std::defaultfloat;
+        std::cout << " truncated=" << capture_in.truncated() << "\n";
+    } else {
+        // datagrams per recvmmsg call
+        std::cout << "STAT ingest syscalls=" << ingest->syscalls() << " datagrams=" << ingest->datagrams()
+                  << " kernel_drops=" << ingest->kernel_drops();
+        if (ingest->syscalls() > 0) std::cout << " avg_batch=" << double(ingest->datagrams()) / double(ingest->syscalls());
+        if (ingest->mode() != UdpIngest::TimestampMode::User) std::cout << " missing_kernel_ts=" << ingest->missing_kernel_ts();
+        if (ingest->busy_poll()) std::cout << " empty_polls=" << ingest->empty_polls();
+        std::cout << "\n";
+        // receive jitter: kernel timestamp -> user space; --jitter-compare prints both modes at startup
+        if (ingest->mode() != UdpIngest::TimestampMode::User) {
+            print_histogram(std::cout, "STAT", "kernel->user_us", ingest->kernel_to_user_ns());
+        }
+        const auto& bh = ingest->batch_hist();
+        for (size_t b = 1; b < bh.size(); ++b) {
+            if (bh[b] != 0) std::cout << "STAT ingest_batch size=" << b << " count=" << bh[b] << "\n";
+        }
+        if (!record_path.empty()) {
+            std::cout << "STAT record datagrams=" << capture_out.records() << " bytes=" << capture_out.bytes() << "\n";
+        }
+    }
 
     std::cout << "SUMMARY Predictor mode=" << effective_mode << "\n";
 
-    close(sock);
+    metrics.close();
+    if (sock >= 0) close(sock);
     return 0;
 }
@@ -0,0 +1,131 @@
+#include "SharedMetrics.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <new>
+
+namespace {
+
+size_t segment_size(size_t slots) { return metrics_slots_offset() + slots * sizeof(MetricsSlot); }
+
+std::string errno_text(const char* what, const std::string& name) {
+    return std::string(what) + "(" + name + "): " + std::strerror(errno);
+}
+
+} // namespace
+
+std::string metrics_shm_name(const std::string& name) {
+    if (!name.empty() && name[0] == '/') return name;
+    // reserve + append rather than insert(0, "/"): the latter trips GCC 12 -Wrestrict at -O3
+    std::string s;
+    s.reserve(name.size() + 1);
+    s += '/';
+    s += name;
+    return s;
+}
+
+MetricsSlot* SharedMetrics::slot_at(void* base, size_t i) {
+    return reinterpret_cast<MetricsSlot*>(static_cast<char*>(base) + metrics_slots_offset() + i * sizeof(MetricsSlot));
+}
+
+bool SharedMetrics::create(const std::string& name, size_t slots, std::string& err) {
+    close();
+    // a segment left by a crashed run is replaced, not reused
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        err = errno_text("shm_open", name);
+        return false;
+    }
+    const size_t size = segment_size(slots);
+    if (ftruncate(fd, off_t(size)) < 0) {
+        err = errno_text("ftruncate", name);
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        err = errno_text("mmap", name);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    name_ = name;
+    base_ = p;
+    size_ = size;
+    slots_ = slots;
+    linked_ = true;
+
+    // the pages are zero-filled; construct the atomics in place, then publish the header last
+    for (size_t i = 0; i < slots; ++i) new (slot_at(base_, i)) MetricsSlot();
+    MetricsHeader* h = new (base_) MetricsHeader();
+    std::memcpy(h->magic, "FIMX", 4);
+    h->version = METRICS_VERSION;
+    h->header_size = sizeof(MetricsHeader);
+    h->slot_size = sizeof(MetricsSlot);
+    h->slots = uint32_t(slots);
+    h->pid = int32_t(getpid());
+    h->start_ts = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+    h->state.store(METRICS_RUNNING, std::memory_order_release);
+    return true;
+}
+
+void SharedMetrics::close() {
+    if (!base_) return;
+    if (linked_) {
+        static_cast<MetricsHeader*>(base_)->state.store(METRICS_EXITED, std::memory_order_release);
+        shm_unlink(name_.c_str());
+        linked_ = false;
+    }
+}
+
+SharedMetrics::~SharedMetrics() {
+    close();
+    if (base_) munmap(base_, size_);
+}
+
+bool MetricsReader::attach(const std::string& name, std::string& err) {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        err = errno_text("shm_open", name);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || size_t(st.st_size) < metrics_slots_offset()) {
+        err = name + ": not a metrics segment (too small)";
+        ::close(fd);
+        return false;
+    }
+    void* p = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        err = errno_text("mmap", name);
+        return false;
+    }
+    const MetricsHeader* h = static_cast<const MetricsHeader*>(p);
+    if (std::memcmp(h->magic, "FIMX", 4) != 0 || h->version != METRICS_VERSION ||
+        h->header_size != sizeof(MetricsHeader) || h->slot_size != sizeof(MetricsSlot) ||
+        segment_size(h->slots) > size_t(st.st_size)) {
+        err = name + ": not a metrics segment, or from a different build (version/layout mismatch)";
+        munmap(p, size_t(st.st_size));
+        return false;
+    }
+    base_ = p;
+    size_ = size_t(st.st_size);
+    return true;
+}
+
+MetricsReader::~MetricsReader() {
+    if (base_) munmap(const_cast<void*>(base_), size_);
+}
+
+const MetricsSlot& MetricsReader::slot(size_t i) const {
+    return *reinterpret_cast<const MetricsSlot*>(static_cast<const char*>(base_) + metrics_slots_offset() +
+                                                 i * sizeof(MetricsSlot));
+}
@@ -0,0 +1,192 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+/*
+ Live engine metrics in a POSIX shared-memory segment (--metrics[=<name>]),
+ read by flow_imbalance_stat without touching the engine.
+ - layout: MetricsHeader, then one cache-aligned MetricsSlot per writer
+   (slot 0 for the single-thread / pipeline engine, slot i for shard i)
+ - every field has exactly one writer thread. Counters are relaxed atomics
+   updated with load + store, not fetch_add: no lock prefix, a plain mov on
+   x86. Values that must be read together (the last tick, the latency
+   percentiles) sit in a seqlock: the writer makes the sequence odd, stores
+   the words, makes it even; readers retry while it is odd or has moved
+ - per tick the process thread writes 3 counters and a 7-word seqlock
+   (~10 ns, bench row metrics/publish_tick); percentiles are recomputed from
+   the engine's cumulative histograms every MetricsSlot::LATENCY_INTERVAL_NS
+   on that same thread (~1 us, metrics/publish_latency)
+ - readers map the segment read-only and never write, so they cannot stall
+   or slow a writer; a torn read is impossible, a stale one is visible
+   through the timestamps
+ The writer unlinks the segment on exit; attached readers keep their mapping
+ and see `state` = exited with the final values.
+*/
+
+// one writer; load + store instead of an atomic RMW
+using MetricCounter = std::atomic<uint64_t>;
+static_assert(MetricCounter::is_always_lock_free, "shared-memory counters must be lock-free (address-free)");
+
+inline void metric_set(MetricCounter& c, uint64_t v) { c.store(v, std::memory_order_relaxed); }
+inline void metric_add(MetricCounter& c, uint64_t n = 1) {
+    c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+// single-writer seqlock around a trivially copyable T, stored as relaxed atomic words
+template <typename T>
+class SeqlockCell {
+    static_assert(std::is_trivially_copyable_v<T>, "seqlock payload is copied word by word");
+    static constexpr size_t WORDS = (sizeof(T) + 7) / 8;
+
+public:
+    void write(const T& v) {
+        uint64_t buf[WORDS] = {};
+        std::memcpy(buf, &v, sizeof(T));
+        const uint64_t s = seq_.load(std::memory_order_relaxed);
+        seq_.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WORDS; ++i) words_[i].store(buf[i], std::memory_order_relaxed);
+        seq_.store(s + 2, std::memory_order_release);
+    }
+    // false if the writer kept it busy for `tries` attempts
+    bool read(T& out, int tries = 1000) const {
+        uint64_t buf[WORDS];
+        for (int t = 0; t < tries; ++t) {
+            const uint64_t s0 = seq_.load(std::memory_order_acquire);
+            if (s0 & 1) continue;
+            for (size_t i = 0; i < WORDS; ++i) buf[i] = words_[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq_.load(std::memory_order_relaxed) != s0) continue;
+            std::memcpy(&out, buf, sizeof(T));
+            return true;
+        }
+        return false;
+    }
+    // number of completed writes
+    uint64_t version() const { return seq_.load(std::memory_order_acquire) / 2; }
+
+private:
+    std::atomic<uint64_t> seq_{0};
+    std::atomic<uint64_t> words_[WORDS] = {};
+};
+
+struct MetricsTick {
+    uint64_t seq;
+    uint32_t symbol;
+    int32_t action;  // 1=BUY, -1=SELL, 0=HOLD
+    double ewma;
+    double ofi;
+    double src_ts;
+    double recv_ts;
+    int32_t bank_vote;      // --bank ensemble vote (BUY configs - SELL configs)
+    uint32_t bank_configs;  // 0 without --bank
+};
+
+// nanoseconds, cumulative since start
+struct MetricsPercentiles {
+    uint64_t count, p50, p90, p99, p999, max;
+};
+
+struct MetricsLatency {
+    MetricsPercentiles recv_decision;
+    MetricsPercentiles src_recv;
+    double updated_ts;  // wall clock of this snapshot, seconds since epoch
+};
+
+struct alignas(64) MetricsSlot {
+    static constexpr int64_t LATENCY_INTERVAL_NS = 100'000'000;
+
+    char label[32];
+
+    // receive thread (decode runs there): per batch
+    alignas(64) MetricCounter datagrams;
+    MetricCounter parse_errors;
+    MetricCounter kernel_drops;     // SO_MEMINFO, sampled at most every LATENCY_INTERVAL_NS
+    MetricCounter tick_ring_drops;  // --pipeline only
+    MetricCounter tick_ring_depth;
+
+    // process thread: per tick (ticks, buy, sell) or per batch
+    alignas(64) MetricCounter ticks;
+    MetricCounter buy;
+    MetricCounter sell;
+    MetricCounter seq_dropped;
+    MetricCounter seq_held;
+    MetricCounter log_drops;
+    MetricCounter log_ring_depth;
+
+    alignas(64) SeqlockCell<MetricsTick> last_tick;
+    alignas(64) SeqlockCell<MetricsLatency> latency;
+};
+
+struct MetricsHeader {
+    char magic[4];          // "FIMX"
+    uint32_t version;       // METRICS_VERSION
+    uint32_t header_size;   // sizeof(MetricsHeader)
+    uint32_t slot_size;     // sizeof(MetricsSlot)
+    uint32_t slots;
+    int32_t pid;
+    double start_ts;        // seconds since epoch
+    std::atomic<uint32_t> state;  // 1 = running, 2 = exited
+};
+
+constexpr uint32_t METRICS_VERSION = 2;
+constexpr uint32_t METRICS_RUNNING = 1;
+constexpr uint32_t METRICS_EXITED = 2;
+inline constexpr const char* METRICS_DEFAULT_NAME = "/flow_imbalance";
+
+// shm_open wants a leading slash; `name` may omit it
+std::string metrics_shm_name(const std::string& name);
+
+// writer: creates (replacing a stale one) and owns the segment
+class SharedMetrics {
+public:
+    SharedMetrics() = default;
+    ~SharedMetrics();
+    SharedMetrics(const SharedMetrics&) = delete;
+    SharedMetrics& operator=(const SharedMetrics&) = delete;
+
+    // `name` as for shm_open ("/x"); false with `err` set on failure
+    bool create(const std::string& name, size_t slots, std::string& err);
+    // mark exited and unlink; the mapping stays valid until destruction
+    void close();
+
+    bool is_open() const { return base_ != nullptr; }
+    const std::string& name() const { return name_; }
+    size_t slots() const { return slots_; }
+    MetricsSlot* slot(size_t i) { return i < slots_ ? slot_at(base_, i) : nullptr; }
+
+private:
+    std::string name_;
+    void* base_ = nullptr;
+    size_t size_ = 0;
+    size_t slots_ = 0;
+    bool linked_ = false;
+
+    static MetricsSlot* slot_at(void* base, size_t i);
+};
+
+// reader: read-only mapping of a live (or just exited) writer's segment
+class MetricsReader {
+public:
+    MetricsReader() = default;
+    ~MetricsReader();
+    MetricsReader(const MetricsReader&) = delete;
+    MetricsReader& operator=(const MetricsReader&) = delete;
+
+    bool attach(const std::string& name, std::string& err);
+
+    const MetricsHeader& header() const { return *static_cast<const MetricsHeader*>(base_); }
+    size_t slots() const { return header().slots; }
+    const MetricsSlot& slot(size_t i) const;
+
+private:
+    const void* base_ = nullptr;
+    size_t size_ = 0;
+};
+
+// byte offset of slot 0: the header padded to a cache line
+constexpr size_t metrics_slots_offset() { return (sizeof(MetricsHeader) + 63) & ~size_t(63); }
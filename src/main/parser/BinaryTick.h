@@ -0,0 +1,108 @@
+#pragma once
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "../OrderBook.h"
+
+/*
+ Binary tick wire format (little-endian, packed, no padding):
+
+   header (4 bytes):     u8 magic = 0xF1 | u8 version | u16 count
+   v1 record (33 bytes): u64 seq | f64 src_ts | f64 price | u32 size | u32 symbol | i8 side
+   v2 record (34 bytes): v1 record | u8 type (TickType: trade/add/modify/delete)
+
+ v1 records are trades. For book updates (v2, type != trade) side is 1 = bid, -1 = ask.
+
+ A datagram carries `count` back-to-back records after the header.
+ The magic byte can never start a CSV line (which begins with a digit), so the
+ receiver can tell the two formats apart from the first byte.
+ Records are decoded by a straight memcpy into the packed struct; the format is
+ only defined for little-endian hosts.
+*/
+
+static_assert(std::endian::native == std::endian::little, "binary tick format assumes a little-endian host");
+
+constexpr uint8_t BINARY_TICK_MAGIC = 0xF1;
+constexpr uint8_t BINARY_TICK_VERSION = 2;   // version written by encode_binary_ticks
+
+#pragma pack(push, 1)
+struct BinaryTickHeader {
+    uint8_t magic;
+    uint8_t version;
+    uint16_t count;
+};
+
+struct BinaryTickV1 {
+    uint64_t seq;
+    double src_ts;
+    double price;
+    uint32_t size;
+    uint32_t symbol;
+    int8_t side;
+};
+
+struct BinaryTickV2 {
+    BinaryTickV1 v1;
+    uint8_t type;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(BinaryTickHeader) == 4, "unexpected header padding");
+static_assert(sizeof(BinaryTickV1) == 33, "unexpected record padding");
+static_assert(sizeof(BinaryTickV2) == 34, "unexpected record padding");
+
+inline size_t binary_record_size(uint8_t version) {
+    return version == 1 ? sizeof(BinaryTickV1) : (version == 2 ? sizeof(BinaryTickV2) : 0);
+}
+
+inline bool is_binary_tick(const char* p, size_t n) {
+    return n > 0 && uint8_t(p[0]) == BINARY_TICK_MAGIC;
+}
+
+// validate the header; returns the record count or -1 if the datagram is malformed
+inline int binary_tick_count(const char* p, size_t n) {
+    if (n < sizeof(BinaryTickHeader)) return -1;
+    BinaryTickHeader h;
+    std::memcpy(&h, p, sizeof(h));
+    size_t rec = binary_record_size(h.version);
+    if (h.magic != BINARY_TICK_MAGIC || rec == 0) return -1;
+    if (n != sizeof(BinaryTickHeader) + size_t(h.count) * rec) return -1;
+    return int(h.count);
+}
+
+// decode record i; the caller must have validated the datagram with binary_tick_count().
+// `out.symbol` receives the raw wire id, to be mapped via SymbolTable::intern_wire()
+inline void decode_binary_tick(const char* p, int i, Tick& out) {
+    BinaryTickV2 r2;
+    const BinaryTickV1& r = r2.v1;
+    if (uint8_t(p[1]) == 1) {
+        std::memcpy(&r2.v1, p + sizeof(BinaryTickHeader) + size_t(i) * sizeof(BinaryTickV1), sizeof(BinaryTickV1));
+        r2.type = uint8_t(TickType::Trade);
+    } else {
+        std::memcpy(&r2, p + sizeof(BinaryTickHeader) + size_t(i) * sizeof(BinaryTickV2), sizeof(r2));
+    }
+    out.seq = r.seq;
+    out.src_ts = r.src_ts;
+    out.price = r.price;
+    out.size = r.size;
+    out.symbol = r.symbol;
+    out.side = r.side;
+    out.type = r2.type <= uint8_t(TickType::Delete) ? TickType(r2.type) : TickType::Trade;
+}
+
+// encode `count` ticks into `dst` (capacity `cap`); each tick's `symbol` is written as the wire id.
+// returns bytes written or 0 if it does not fit
+inline size_t encode_binary_ticks(const Tick* ticks, size_t count, char* dst, size_t cap) {
+    size_t need = sizeof(BinaryTickHeader) + count * sizeof(BinaryTickV2);
+    if (count > UINT16_MAX || need > cap) return 0;
+    BinaryTickHeader h{BINARY_TICK_MAGIC, BINARY_TICK_VERSION, uint16_t(count)};
+    std::memcpy(dst, &h, sizeof(h));
+    for (size_t i = 0; i < count; ++i) {
+        BinaryTickV2 r{{ticks[i].seq, ticks[i].src_ts, ticks[i].price, ticks[i].size, ticks[i].symbol, ticks[i].side},
+                       uint8_t(ticks[i].type)};
+        std::memcpy(dst + sizeof(h) + i * sizeof(r), &r, sizeof(r));
+    }
+    return need;
+}
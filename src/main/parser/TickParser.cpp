@@ -0,0 +1,153 @@
+#include "TickParser.h"
+
+#include <charconv>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// exact powers of ten representable as double
+constexpr double kPow10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+constexpr uint64_t kExactMantissa = uint64_t(1) << 53;
+constexpr int kMaxDigits = 19; // fits in uint64 without overflow
+
+inline bool is_digit(char c) { return unsigned(c - '0') < 10u; }
+
+// locate up to `max` commas in [p, p+n); returns how many were found (capped at max+1
+// so callers can detect surplus fields)
+inline int find_commas(const char* p, size_t n, size_t* pos, int max) {
+    int found = 0;
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i comma = _mm_set1_epi8(',');
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        unsigned mask = unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(v, comma)));
+        while (mask != 0) {
+            if (found == max) return max + 1;
+            pos[found++] = i + size_t(__builtin_ctz(mask));
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; i < n; ++i) {
+        if (p[i] == ',') {
+            if (found == max) return max + 1;
+            pos[found++] = i;
+        }
+    }
+    return found;
+}
+
+// unsigned integer over the whole range [b, e)
+template <typename T>
+inline bool parse_uint(const char* b, const char* e, T max_val, T& out) {
+    if (b == e) return false;
+    uint64_t v = 0;
+    int digits = 0;
+    for (; b != e; ++b) {
+        if (!is_digit(*b)) return false;
+        uint64_t d = uint64_t(*b - '0');
+        if (++digits > kMaxDigits) {
+            // 20th digit: only valid if it does not overflow uint64
+            if (v > (UINT64_MAX - d) / 10) return false;
+        }
+        v = v * 10 + d;
+    }
+    if (v > uint64_t(max_val)) return false;
+    out = T(v);
+    return true;
+}
+
+// fixed-point decimal `[-]ddd[.ddd]` over the whole range [b, e)
+inline bool parse_decimal(const char* b, const char* e, double& out) {
+    if (b == e) return false;
+    bool neg = false;
+    if (*b == '-' || *b == '+') { neg = (*b == '-'); ++b; }
+    const char* s = b;
+
+    uint64_t ip = 0;
+    int idigits = 0;
+    int sig = 0;  // significant digits taken so far; leading zeros do not count
+    while (b != e && is_digit(*b)) {
+        if (++idigits > kMaxDigits) return false;
+        ip = ip * 10 + uint64_t(*b - '0');
+        if (ip != 0) ++sig;
+        ++b;
+    }
+    bool have_digits = b != s;
+
+    uint64_t fp = 0;
+    int fdigits = 0;
+    if (b != e && *b == '.') {
+        ++b;
+        const char* fs = b;
+        while (b != e && is_digit(*b)) {
+            // digits beyond what fits are below double resolution; drop them
+            if (sig < kMaxDigits) {
+                fp = fp * 10 + uint64_t(*b - '0');
+                ++fdigits;
+                if (ip != 0 || fp != 0) ++sig;
+            }
+            ++b;
+        }
+        have_digits = have_digits || b != fs;
+    }
+    if (!have_digits || b != e) return false;
+
+    double v;
+    if (fdigits == 0) {
+        v = double(ip);
+    } else if (fdigits > 22) {
+        // only with ip == 0, whose leading fraction zeros are not significant: the scale is past
+        // the exact powers of ten, so leave this rare case to the library (syntax already checked)
+        if (std::from_chars(s, e, v, std::chars_format::fixed).ec != std::errc()) return false;
+    } else {
+        // combined mantissa ip * 10^f + fp (< 10^19: with ip != 0 every fraction digit is
+        // significant); exact single division when it fits 53 bits
+        uint64_t m = ip == 0 ? fp : ip * uint64_t(kPow10[fdigits]) + fp;
+        if (m <= kExactMantissa) v = double(m) / kPow10[fdigits];
+        else v = double(ip) + double(fp) / kPow10[fdigits];
+    }
+    out = neg ? -v : v;
+    return true;
+}
+
+} // namespace
+
+ParseError parse_tick_csv(const char* p, size_t n, Tick& out, std::string_view& symbol) {
+    // trim trailing line terminators / whitespace
+    while (n > 0 && (p[n - 1] == '\n' || p[n - 1] == '\r' || p[n - 1] == ' ' || p[n - 1] == '\0')) --n;
+    if (n == 0) return ParseError::Empty;
+
+    size_t c[4];
+    int commas = find_commas(p, n, c, 4);
+    if (commas != 3 && commas != 4) return ParseError::Fields;
+
+    const char* end = p + n;
+    const char* size_end = end;
+    symbol = std::string_view();
+    if (commas == 4) {
+        size_end = p + c[3];
+        if (size_end + 1 == end) return ParseError::BadSymbol;
+        symbol = std::string_view(size_end + 1, size_t(end - size_end - 1));
+    }
+    uint64_t seq;
+    double src_ts, price;
+    uint32_t size;
+    if (!parse_uint<uint64_t>(p, p + c[0], UINT64_MAX, seq)) return ParseError::BadSeq;
+    if (!parse_decimal(p + c[0] + 1, p + c[1], src_ts)) return ParseError::BadSrcTs;
+    if (!parse_decimal(p + c[1] + 1, p + c[2], price)) return ParseError::BadPrice;
+    if (!parse_uint<uint32_t>(p + c[2] + 1, size_end, UINT32_MAX, size)) return ParseError::BadSize;
+
+    out.seq = seq;
+    out.src_ts = src_ts;
+    out.price = price;
+    out.size = size;
+    return ParseError::None;
+}
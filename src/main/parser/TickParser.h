@@ -0,0 +1,80 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "../OrderBook.h"
+#include "BinaryTick.h"
+
+/*
+ Allocation-free parser for the `seq,src_ts,price,size[,symbol]` CSV tick line.
+ - comma positions are located with a 16-byte SSE2 scan (scalar tail / fallback)
+ - integers and fixed-point decimals are converted by hand, no locale, no sscanf
+ - decimals with <= 15 significant digits convert exactly like strtod; longer
+   ones (e.g. ns epoch timestamps) are within 1 ulp. Leading zeros are not
+   significant, so 0.000...0123 keeps its digits
+ - src/gen/parser_corpus.txt pins this down against feedgen.py output and edge
+   cases; ctest runs it through flow_imbalance_parsecheck
+ - exponent notation, NaN/inf and empty fields are rejected
+ - malformed lines are classified and counted rather than silently dropped
+*/
+
+enum class ParseError : uint8_t {
+    None = 0,
+    Empty,      // empty or whitespace-only datagram
+    Fields,     // wrong number of comma-separated fields
+    BadSeq,
+    BadSrcTs,
+    BadPrice,
+    BadSize,
+    BadSymbol,  // symbol field present but empty
+};
+
+struct ParseCounters {
+    uint64_t ok = 0;
+    uint64_t empty = 0;
+    uint64_t fields = 0;
+    uint64_t bad_seq = 0;
+    uint64_t bad_src_ts = 0;
+    uint64_t bad_price = 0;
+    uint64_t bad_size = 0;
+    uint64_t bad_symbol = 0;
+    uint64_t bad_binary = 0;   // binary datagram with bad version or length
+
+    uint64_t errors() const { return empty + fields + bad_seq + bad_src_ts + bad_price + bad_size + bad_symbol + bad_binary; }
+};
+
+// parse one line of `n` bytes (need not be NUL-terminated; trailing CR/LF ignored).
+// fills seq, src_ts, price and size of `out`; other fields are left untouched.
+// `symbol` is set to the optional fifth field (a view into `p`), or left empty.
+ParseError parse_tick_csv(const char* p, size_t n, Tick& out, std::string_view& symbol);
+
+class TickParser {
+public:
+    // returns true and fills `out` on success, otherwise bumps the matching error counter
+    bool parse(const char* p, size_t n, Tick& out, std::string_view& symbol) {
+        ParseError e = parse_tick_csv(p, n, out, symbol);
+        switch (e) {
+            case ParseError::None: ++c_.ok; return true;
+            case ParseError::Empty: ++c_.empty; break;
+            case ParseError::Fields: ++c_.fields; break;
+            case ParseError::BadSeq: ++c_.bad_seq; break;
+            case ParseError::BadSrcTs: ++c_.bad_src_ts; break;
+            case ParseError::BadPrice: ++c_.bad_price; break;
+            case ParseError::BadSize: ++c_.bad_size; break;
+            case ParseError::BadSymbol: ++c_.bad_symbol; break;
+        }
+        return false;
+    }
+    // validate a binary datagram (see BinaryTick.h); returns record count, 0 if malformed
+    int binary_count(const char* p, size_t n) {
+        int cnt = binary_tick_count(p, n);
+        if (cnt < 0) { ++c_.bad_binary; return 0; }
+        c_.ok += uint64_t(cnt);
+        return cnt;
+    }
+    const ParseCounters& counters() const { return c_; }
+
+private:
+    ParseCounters c_;
+};
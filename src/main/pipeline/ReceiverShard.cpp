@@ -0,0 +1,109 @@
+#include "ReceiverShard.h"
+
+#include <unistd.h>
+
+#include <chrono>
+#include <iostream>
+
+#include "../ingest/UdpSocket.h"
+#include "../runtime/LowLatency.h"
+
+namespace {
+
+// upper bound on how long a shard blocks in recvmmsg, so it notices shutdown
+constexpr double MAX_IDLE_WAIT_S = 0.1;
+
+EngineConfig shard_engine_config(const EngineConfig& cfg, size_t id) {
+    EngineConfig c = cfg;
+    c.report_prefix = "INTERVAL shard=" + std::to_string(id);
+    return c;
+}
+
+} // namespace
+
+ReceiverShard::ReceiverShard(size_t id, int sock, const EngineConfig& engine_cfg, const ShardConfig& cfg)
+    : id_(id),
+      sock_(sock),
+      cfg_(cfg),
+      engine_(shard_engine_config(engine_cfg, id)),
+      ingest_(sock, cfg.batch, 2047, cfg.ts_mode),
+      log_(cfg.log_ring, engine_.symbols()) {}
+
+ReceiverShard::~ReceiverShard() {
+    join();
+    if (sock_ >= 0) close(sock_);
+}
+
+bool ReceiverShard::start(const std::atomic<bool>& keep_running) {
+    if (thread_.joinable()) return true;
+    ingest_.init();
+    ingest_.set_busy_poll(cfg_.busy_poll);
+    set_receive_timeout(sock_, MAX_IDLE_WAIT_S);
+    if (!cfg_.signal_log_path.empty() && !log_.open_binary(cfg_.signal_log_path)) return false;
+    if (!cfg_.echo_dest.empty() && !echo_.open(cfg_.echo_dest, cfg_.echo_every)) return false;
+    if (!cfg_.store.dir.empty()) {
+        store_.reset(new TickStore(cfg_.store, engine_.symbols()));
+        std::string err;
+        if (!store_->open(err)) {
+            std::cerr << "shard " << id_ << ": store: " << err << "\n";
+            return false;
+        }
+        store_->start();
+        engine_.set_tick_store(store_.get(), false);
+    }
+    engine_.set_output(&log_, &echo_, false);
+    log_.start();
+    thread_ = std::thread([this, &keep_running] { run(keep_running); });
+    return true;
+}
+
+void ReceiverShard::set_metrics(MetricsSlot* m) {
+    metrics_ = m;
+    engine_.set_metrics(m);
+}
+
+// after every batch, on the shard thread; SO_MEMINFO is a syscall, so kernel drops are sampled
+void ReceiverShard::publish_metrics() {
+    MetricsSlot& m = *metrics_;
+    metric_set(m.datagrams, ingest_.datagrams());
+    metric_set(m.parse_errors, engine_.parse_counters().errors());
+    metric_set(m.log_drops, log_.drops());
+    metric_set(m.log_ring_depth, log_.depth());
+    const int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                               std::chrono::steady_clock::now().time_since_epoch()).count();
+    if (now_ns >= next_drop_sample_ns_) {
+        metric_set(m.kernel_drops, ingest_.kernel_drops());
+        next_drop_sample_ns_ = now_ns + MetricsSlot::LATENCY_INTERVAL_NS;
+    }
+}
+
+void ReceiverShard::join() {
+    if (!thread_.joinable()) return;
+    thread_.join();
+    log_.stop();
+    if (store_) store_->stop();
+    kernel_drops_ = ingest_.kernel_drops();
+}
+
+void ReceiverShard::run(const std::atomic<bool>& keep_running) {
+    std::string err;
+    if (cfg_.cpu >= 0 && !pin_current_thread(cfg_.cpu, err)) {
+        pinned_ = false;
+        std::cerr << "shard " << id_ << ": cannot pin to cpu " << cfg_.cpu << ": " << err << "\n";
+    }
+    if (cfg_.fifo_priority > 0) {
+        realtime_ = set_fifo_priority(cfg_.fifo_priority, err);
+        if (!realtime_) std::cerr << "shard " << id_ << ": SCHED_FIFO refused: " << err << "\n";
+    }
+    auto deliver = [&](const Tick& tick) { engine_.deliver(tick); };
+    while (keep_running.load(std::memory_order_relaxed)) {
+        int got = ingest_.receive_batch();
+        for (int k = 0; k < got; ++k) engine_.decode(ingest_.data(k), ingest_.length(k), ingest_.recv_ts(k), deliver);
+        if (got > 0) {
+            if (first_recv_ts_ == 0.0) first_recv_ts_ = ingest_.recv_ts(0);
+            last_recv_ts_ = ingest_.recv_ts(got - 1);
+        }
+        if (metrics_) publish_metrics();
+    }
+    if (metrics_) publish_metrics();
+}
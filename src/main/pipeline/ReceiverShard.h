@@ -0,0 +1,102 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "../Engine.h"
+#include "../ingest/Echo.h"
+#include "../ingest/UdpIngest.h"
+#include "../log/SignalLog.h"
+#include "../metrics/SharedMetrics.h"
+#include "../store/TickStore.h"
+
+/*
+ One receiver shard: a socket (typically one of several SO_REUSEPORT sockets
+ on the same port) served end to end by its own thread.
+ - the thread is pinned to `cpu` and runs receive -> decode -> process -> log
+   inline, like the single-threaded mode
+ - every piece of state is private: ingest buffers, symbol table, books,
+   EWMAs, signal log ring and tick store, so shards share no cache lines and
+   take no locks. The kernel keeps each flow on one socket, so per-symbol
+   and per-publisher order holds within a shard
+ - no Sequencer: the kernel hashes each source 4-tuple to a shard, so a
+   publisher sending from several ports (flow_imbalance_loadgen --threads)
+   has its one seq space split over shards, each of which would see
+   permanent gaps
+ - counters are plain fields read after join(); with set_metrics() the
+   thread also publishes them live, as the only writer of its slot
+*/
+
+struct ShardConfig {
+    size_t batch = 64;
+    UdpIngest::TimestampMode ts_mode = UdpIngest::TimestampMode::User;
+    size_t log_ring = 65536;
+    // binary signal log for this shard; empty = text to stdout
+    std::string signal_log_path;
+    // CPU to pin the thread to, -1 = unpinned
+    int cpu = -1;
+    // --low-latency: spin on the socket instead of blocking; SCHED_FIFO priority (0 = normal)
+    bool busy_poll = false;
+    int fifo_priority = 0;
+    // closed-loop acks to the load generator (<ipv4>:<port>, empty = off) for every n-th seq
+    std::string echo_dest;
+    uint32_t echo_every = 100;
+    // per-tick columnar store for this shard (store.dir empty = off)
+    TickStoreConfig store;
+};
+
+class ReceiverShard {
+public:
+    // takes ownership of `sock`
+    ReceiverShard(size_t id, int sock, const EngineConfig& engine_cfg, const ShardConfig& cfg);
+    ~ReceiverShard();
+
+    // open the log and start the thread; it runs until `keep_running` is cleared
+    bool start(const std::atomic<bool>& keep_running);
+    // publish live counters to `m` (see metrics/SharedMetrics.h); call before start()
+    void set_metrics(MetricsSlot* m);
+    void join();
+
+    size_t id() const { return id_; }
+    int cpu() const { return cfg_.cpu; }
+    // false if pinning / SCHED_FIFO was requested and refused
+    bool pinned() const { return pinned_; }
+    bool realtime() const { return realtime_; }
+    // receive time of the first to the last datagram
+    double active_s() const { return last_recv_ts_ > first_recv_ts_ ? last_recv_ts_ - first_recv_ts_ : 0.0; }
+    uint64_t decisions() const { return engine_.decisions(); }
+    // sampled by join() before the socket closes
+    uint64_t kernel_drops() const { return kernel_drops_; }
+
+    const Engine& engine() const { return engine_; }
+    const UdpIngest& ingest() const { return ingest_; }
+    const SignalLog& signal_log() const { return log_; }
+    const EchoSender& echo() const { return echo_; }
+    // null without ShardConfig::store
+    const TickStore* tick_store() const { return store_.get(); }
+
+private:
+    size_t id_;
+    int sock_;
+    ShardConfig cfg_;
+    Engine engine_;
+    UdpIngest ingest_;
+    SignalLog log_;
+    EchoSender echo_;
+    std::unique_ptr<TickStore> store_;
+    std::thread thread_;
+
+    bool pinned_ = true;
+    bool realtime_ = false;
+    double first_recv_ts_ = 0.0;
+    double last_recv_ts_ = 0.0;
+    uint64_t kernel_drops_ = 0;
+    MetricsSlot* metrics_ = nullptr;
+    int64_t next_drop_sample_ns_ = 0;
+
+    void publish_metrics();
+    void run(const std::atomic<bool>& keep_running);
+};
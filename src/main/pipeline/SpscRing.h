@@ -0,0 +1,101 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <thread>
+#include <vector>
+
+/*
+ Bounded lock-free single-producer / single-consumer ring.
+ - slots are preallocated; push/pop copy into/out of them, never allocate
+ - capacity is rounded up to a power of two so indices wrap with a mask
+ - head and tail live on separate cache lines, and each side keeps a cached
+   copy of the other's index so the shared line is only read when the ring
+   looks full (producer) or empty (consumer)
+ - try_push on a full ring fails and counts a drop; the caller decides
+   whether to retry or shed the item. push waits for space instead, for
+   offline producers (replay) where nothing may be shed
+*/
+
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity) {
+        size_t cap = 2;
+        while (cap < capacity) cap <<= 1;
+        slots_.resize(cap);
+        mask_ = cap - 1;
+    }
+
+    // producer side
+    bool try_push(const T& v) {
+        const uint64_t t = tail_.load(std::memory_order_relaxed);
+        if (t - head_cache_ > mask_) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (t - head_cache_ > mask_) {
+                ++drops_;
+                return false;
+            }
+        }
+        publish(t, v);
+        return true;
+    }
+
+    // producer side, yielding while the ring is full; never drops
+    void push(const T& v) {
+        const uint64_t t = tail_.load(std::memory_order_relaxed);
+        while (t - head_cache_ > mask_) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (t - head_cache_ > mask_) std::this_thread::yield();
+        }
+        publish(t, v);
+    }
+
+    // consumer side
+    bool try_pop(T& out) {
+        const uint64_t h = head_.load(std::memory_order_relaxed);
+        if (h == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (h == tail_cache_) return false;
+        }
+        out = slots_[h & mask_];
+        head_.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // approximate current occupancy; safe from either side
+    size_t size() const {
+        return size_t(tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire));
+    }
+    size_t capacity() const { return mask_ + 1; }
+    // producer-side counters: read after the producer has stopped
+    uint64_t drops() const { return drops_; }
+    // highest occupancy seen by the producer's periodic samples
+    uint64_t high_water() const { return high_water_; }
+
+private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    void publish(uint64_t t, const T& v) {
+        slots_[t & mask_] = v;
+        tail_.store(t + 1, std::memory_order_release);
+        // occupancy is sampled every 64 pushes to keep the consumer's line out of the fast path
+        if ((t & 63) == 0) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            uint64_t occ = t + 1 - head_cache_;
+            if (occ > high_water_) high_water_ = occ;
+        }
+    }
+
+    std::vector<T> slots_;
+    size_t mask_ = 0;
+
+    alignas(CACHE_LINE) std::atomic<uint64_t> tail_{0};
+    uint64_t head_cache_ = 0;
+    uint64_t drops_ = 0;
+    uint64_t high_water_ = 0;
+
+    alignas(CACHE_LINE) std::atomic<uint64_t> head_{0};
+    uint64_t tail_cache_ = 0;
+};
@@ -0,0 +1,80 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(size_t threads) {
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    nthreads_ = threads == 0 ? 1 : threads;
+    ranges_.reset(new Range[nthreads_]);
+    // slot 0 belongs to the thread calling parallel_for
+    for (size_t i = 1; i < nthreads_; ++i) workers_.emplace_back(&ThreadPool::worker, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        stop_ = true;
+    }
+    start_cv_.notify_all();
+    for (auto& t : workers_) t.join();
+}
+
+void ThreadPool::parallel_for(size_t n, const std::function<void(size_t)>& fn) {
+    if (n == 0) return;
+    if (nthreads_ == 1 || n == 1) {
+        for (size_t i = 0; i < n; ++i) fn(i);
+        return;
+    }
+    const size_t per = n / nthreads_;
+    const size_t extra = n % nthreads_;
+    size_t begin = 0;
+    for (size_t i = 0; i < nthreads_; ++i) {
+        size_t len = per + (i < extra ? 1 : 0);
+        ranges_[i].end = begin + len;
+        ranges_[i].next.store(begin, std::memory_order_relaxed);
+        begin += len;
+    }
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        fn_ = &fn;
+        running_ = workers_.size();
+        ++generation_;  // the mutex publishes the ranges to the workers
+    }
+    start_cv_.notify_all();
+
+    run_tasks(0);
+
+    std::unique_lock<std::mutex> lk(mtx_);
+    done_cv_.wait(lk, [&] { return running_ == 0; });
+    fn_ = nullptr;
+}
+
+void ThreadPool::worker(size_t id) {
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lk(mtx_);
+            start_cv_.wait(lk, [&] { return stop_ || generation_ != seen; });
+            if (stop_) return;
+            seen = generation_;
+        }
+        run_tasks(id);
+        std::lock_guard<std::mutex> lk(mtx_);
+        if (--running_ == 0) done_cv_.notify_one();
+    }
+}
+
+void ThreadPool::run_tasks(size_t id) {
+    const auto& fn = *fn_;
+    // own range first; `next` may run past `end`, which simply means empty
+    Range& own = ranges_[id];
+    for (size_t i; (i = own.next.fetch_add(1, std::memory_order_relaxed)) < own.end;) fn(i);
+
+    uint64_t stolen = 0;
+    for (size_t k = 1; k < nthreads_; ++k) {
+        Range& victim = ranges_[(id + k) % nthreads_];
+        for (size_t i; (i = victim.next.fetch_add(1, std::memory_order_relaxed)) < victim.end;) {
+            fn(i);
+            ++stolen;
+        }
+    }
+    if (stolen) steals_.fetch_add(stolen, std::memory_order_relaxed);
+}
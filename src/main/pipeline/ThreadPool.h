@@ -0,0 +1,60 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ Fixed-size fork/join pool for data-parallel loops.
+ - parallel_for(n, fn) runs fn(0..n-1) across `size()` threads, the caller
+   being one of them, and returns once every task has finished
+ - task indices are split into one contiguous range per thread; a thread
+   drains its own range first and then steals single tasks from the others,
+   so uneven task costs still balance without a shared queue
+ - claiming a task is one fetch_add on a per-thread cache line; the mutex is
+   only taken to start and finish a loop
+ - one loop at a time: parallel_for must not be called concurrently or from
+   inside a task
+*/
+
+class ThreadPool {
+public:
+    // threads == 0 picks std::thread::hardware_concurrency()
+    explicit ThreadPool(size_t threads = 0);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return nthreads_; }
+    void parallel_for(size_t n, const std::function<void(size_t)>& fn);
+
+    // tasks a thread took from another thread's range, summed over all loops
+    uint64_t steals() const { return steals_.load(std::memory_order_relaxed); }
+
+private:
+    struct alignas(64) Range {
+        std::atomic<size_t> next{0};
+        size_t end = 0;
+    };
+
+    size_t nthreads_;
+    std::unique_ptr<Range[]> ranges_;
+    std::vector<std::thread> workers_;
+
+    std::mutex mtx_;
+    std::condition_variable start_cv_;
+    std::condition_variable done_cv_;
+    uint64_t generation_ = 0;
+    size_t running_ = 0;
+    bool stop_ = false;
+    const std::function<void(size_t)>* fn_ = nullptr;
+    std::atomic<uint64_t> steals_{0};
+
+    void worker(size_t id);
+    void run_tasks(size_t id);
+};
@@ -0,0 +1,267 @@
+#include "BatchKernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define FI_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+inline int classify(double ewma, double threshold) {
+    int pred = 0;
+    if (ewma > threshold) pred = 1;
+    else if (ewma < -threshold) pred = -1;
+    return pred;
+}
+
+// continue the scalar recurrence for one sequence from sample `from`; returns the final EWMA
+inline double scalar_tail(const double* x, int* o, size_t from, size_t seq_len,
+                          double alpha, double decay, double threshold, double ewma) {
+    for (size_t i = from; i < seq_len; ++i) {
+        ewma = alpha * x[i] + decay * ewma;
+        o[i] = classify(ewma, threshold);
+    }
+    return ewma;
+}
+
+} // namespace
+
+void ewma_batch_scalar(const double* data, size_t num_seqs, size_t seq_len,
+                       double alpha, double threshold, int* out,
+                       const double* init, double* final_ewma) {
+    const double decay = 1.0 - alpha;
+    for (size_t s = 0; s < num_seqs; ++s) {
+        double e = scalar_tail(data + s * seq_len, out + s * seq_len, 0, seq_len, alpha, decay, threshold,
+                               init ? init[s] : 0.0);
+        if (final_ewma) final_ewma[s] = e;
+    }
+}
+
+#ifdef FI_X86
+
+// Each kernel steps G groups of L sequences per time block. The groups' EWMA
+// chains are independent, so interleaving them hides the mul+add latency that
+// otherwise bounds a single group.
+
+template <size_t G>
+__attribute__((target("avx2")))
+void avx2_groups(const double* data, size_t s, size_t seq_len, double alpha, double threshold, int* out,
+                 const double* init, double* final_ewma) {
+    constexpr size_t L = 4;
+    const double decay = 1.0 - alpha;
+    const __m256d va = _mm256_set1_pd(alpha);
+    const __m256d vd = _mm256_set1_pd(decay);
+    const __m256d vthr = _mm256_set1_pd(threshold);
+    const __m256d vnthr = _mm256_set1_pd(-threshold);
+    const __m256i narrow = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+    const size_t full_t = seq_len - seq_len % L;
+
+    const double* x[G][L];
+    int* o[G][L];
+    __m256d e[G];
+    for (size_t g = 0; g < G; ++g) {
+        for (size_t l = 0; l < L; ++l) {
+            x[g][l] = data + (s + g * L + l) * seq_len;
+            o[g][l] = out + (s + g * L + l) * seq_len;
+        }
+        e[g] = init ? _mm256_loadu_pd(init + s + g * L) : _mm256_setzero_pd();
+    }
+    for (size_t i = 0; i < full_t; i += L) {
+        for (size_t g = 0; g < G; ++g) {
+            // 4x4 block: row l = 4 samples of sequence l -> c[t] = sample t of all 4 sequences
+            __m256d r0 = _mm256_loadu_pd(x[g][0] + i), r1 = _mm256_loadu_pd(x[g][1] + i);
+            __m256d r2 = _mm256_loadu_pd(x[g][2] + i), r3 = _mm256_loadu_pd(x[g][3] + i);
+            __m256d t0 = _mm256_unpacklo_pd(r0, r1), t1 = _mm256_unpackhi_pd(r0, r1);
+            __m256d t2 = _mm256_unpacklo_pd(r2, r3), t3 = _mm256_unpackhi_pd(r2, r3);
+            __m256d c[L] = {
+                _mm256_permute2f128_pd(t0, t2, 0x20), _mm256_permute2f128_pd(t1, t3, 0x20),
+                _mm256_permute2f128_pd(t0, t2, 0x31), _mm256_permute2f128_pd(t1, t3, 0x31),
+            };
+            __m128 p[L];
+            for (size_t t = 0; t < L; ++t) {
+                e[g] = _mm256_add_pd(_mm256_mul_pd(va, c[t]), _mm256_mul_pd(vd, e[g]));
+                __m256d gt = _mm256_cmp_pd(e[g], vthr, _CMP_GT_OQ);
+                __m256d lt = _mm256_andnot_pd(gt, _mm256_cmp_pd(e[g], vnthr, _CMP_LT_OQ));
+                // masks are -1/0 per lane: lt - gt gives -1 / +1 / 0
+                __m256i v = _mm256_sub_epi64(_mm256_castpd_si256(lt), _mm256_castpd_si256(gt));
+                p[t] = _mm_castsi128_ps(_mm256_castsi256_si128(_mm256_permutevar8x32_epi32(v, narrow)));
+            }
+            // back to sequence-major: row l = 4 predictions of sequence l
+            _MM_TRANSPOSE4_PS(p[0], p[1], p[2], p[3]);
+            for (size_t l = 0; l < L; ++l) _mm_storeu_si128(reinterpret_cast<__m128i*>(o[g][l] + i), _mm_castps_si128(p[l]));
+        }
+    }
+    if (full_t != seq_len || final_ewma) {
+        for (size_t g = 0; g < G; ++g) {
+            alignas(32) double ev[L];
+            _mm256_store_pd(ev, e[g]);
+            for (size_t l = 0; l < L; ++l) {
+                double f = scalar_tail(x[g][l], o[g][l], full_t, seq_len, alpha, decay, threshold, ev[l]);
+                if (final_ewma) final_ewma[s + g * L + l] = f;
+            }
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+void ewma_batch_avx2(const double* data, size_t num_seqs, size_t seq_len,
+                     double alpha, double threshold, int* out,
+                     const double* init, double* final_ewma) {
+    size_t s = 0;
+    for (; s + 8 <= num_seqs; s += 8) avx2_groups<2>(data, s, seq_len, alpha, threshold, out, init, final_ewma);
+    for (; s + 4 <= num_seqs; s += 4) avx2_groups<1>(data, s, seq_len, alpha, threshold, out, init, final_ewma);
+    if (s < num_seqs) {
+        ewma_batch_scalar(data + s * seq_len, num_seqs - s, seq_len, alpha, threshold, out + s * seq_len,
+                          init ? init + s : nullptr, final_ewma ? final_ewma + s : nullptr);
+    }
+}
+
+// GCC 12 warns about the deliberately undefined pass-through operand inside
+// the AVX-512 intrinsic headers (GCC PR105593); the code itself is clean
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+template <size_t G>
+__attribute__((target("avx512f,avx2")))
+void avx512_groups(const double* data, size_t s, size_t seq_len, double alpha, double threshold, int* out,
+                   const double* init, double* final_ewma) {
+    constexpr size_t L = 8;
+    const double decay = 1.0 - alpha;
+    const __m512d va = _mm512_set1_pd(alpha);
+    const __m512d vd = _mm512_set1_pd(decay);
+    const __m512d vthr = _mm512_set1_pd(threshold);
+    const __m512d vnthr = _mm512_set1_pd(-threshold);
+    const __m512i one = _mm512_set1_epi32(1);
+    const size_t full_t = seq_len - seq_len % L;
+
+    const double* x[G][L];
+    int* o[G][L];
+    __m512d e[G];
+    for (size_t g = 0; g < G; ++g) {
+        for (size_t l = 0; l < L; ++l) {
+            x[g][l] = data + (s + g * L + l) * seq_len;
+            o[g][l] = out + (s + g * L + l) * seq_len;
+        }
+        e[g] = init ? _mm512_loadu_pd(init + s + g * L) : _mm512_setzero_pd();
+    }
+    for (size_t i = 0; i < full_t; i += L) {
+        for (size_t g = 0; g < G; ++g) {
+            // 8x8 transpose: unpack pairs, then regroup 128-bit lanes twice
+            __m512d r[L];
+            for (size_t l = 0; l < L; ++l) r[l] = _mm512_loadu_pd(x[g][l] + i);
+            __m512d t[L];
+            for (size_t l = 0; l < L; l += 2) {
+                t[l] = _mm512_unpacklo_pd(r[l], r[l + 1]);
+                t[l + 1] = _mm512_unpackhi_pd(r[l], r[l + 1]);
+            }
+            __m512d u[L] = {
+                _mm512_shuffle_f64x2(t[0], t[2], 0x88), _mm512_shuffle_f64x2(t[1], t[3], 0x88),
+                _mm512_shuffle_f64x2(t[0], t[2], 0xDD), _mm512_shuffle_f64x2(t[1], t[3], 0xDD),
+                _mm512_shuffle_f64x2(t[4], t[6], 0x88), _mm512_shuffle_f64x2(t[5], t[7], 0x88),
+                _mm512_shuffle_f64x2(t[4], t[6], 0xDD), _mm512_shuffle_f64x2(t[5], t[7], 0xDD),
+            };
+            __m512d c[L] = {
+                _mm512_shuffle_f64x2(u[0], u[4], 0x88), _mm512_shuffle_f64x2(u[1], u[5], 0x88),
+                _mm512_shuffle_f64x2(u[2], u[6], 0x88), _mm512_shuffle_f64x2(u[3], u[7], 0x88),
+                _mm512_shuffle_f64x2(u[0], u[4], 0xDD), _mm512_shuffle_f64x2(u[1], u[5], 0xDD),
+                _mm512_shuffle_f64x2(u[2], u[6], 0xDD), _mm512_shuffle_f64x2(u[3], u[7], 0xDD),
+            };
+            __m256 p[L];
+            for (size_t k = 0; k < L; ++k) {
+                e[g] = _mm512_add_pd(_mm512_mul_pd(va, c[k]), _mm512_mul_pd(vd, e[g]));
+                __mmask8 gt = _mm512_cmp_pd_mask(e[g], vthr, _CMP_GT_OQ);
+                __mmask8 lt = __mmask8(_mm512_cmp_pd_mask(e[g], vnthr, _CMP_LT_OQ) & ~gt);
+                __m512i v = _mm512_sub_epi32(_mm512_maskz_mov_epi32(__mmask16(gt), one),
+                                             _mm512_maskz_mov_epi32(__mmask16(lt), one));
+                p[k] = _mm256_castsi256_ps(_mm512_castsi512_si256(v));
+            }
+            // 8x8 int32 transpose back to sequence-major
+            __m256 a[L], b[L];
+            for (size_t k = 0; k < L; k += 2) {
+                a[k] = _mm256_unpacklo_ps(p[k], p[k + 1]);
+                a[k + 1] = _mm256_unpackhi_ps(p[k], p[k + 1]);
+            }
+            b[0] = _mm256_shuffle_ps(a[0], a[2], 0x44); b[1] = _mm256_shuffle_ps(a[0], a[2], 0xEE);
+            b[2] = _mm256_shuffle_ps(a[1], a[3], 0x44); b[3] = _mm256_shuffle_ps(a[1], a[3], 0xEE);
+            b[4] = _mm256_shuffle_ps(a[4], a[6], 0x44); b[5] = _mm256_shuffle_ps(a[4], a[6], 0xEE);
+            b[6] = _mm256_shuffle_ps(a[5], a[7], 0x44); b[7] = _mm256_shuffle_ps(a[5], a[7], 0xEE);
+            for (size_t l = 0; l < 4; ++l) {
+                __m256 lo = _mm256_permute2f128_ps(b[l], b[l + 4], 0x20);
+                __m256 hi = _mm256_permute2f128_ps(b[l], b[l + 4], 0x31);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(o[g][l] + i), _mm256_castps_si256(lo));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(o[g][l + 4] + i), _mm256_castps_si256(hi));
+            }
+        }
+    }
+    if (full_t != seq_len || final_ewma) {
+        for (size_t g = 0; g < G; ++g) {
+            alignas(64) double ev[L];
+            _mm512_store_pd(ev, e[g]);
+            for (size_t l = 0; l < L; ++l) {
+                double f = scalar_tail(x[g][l], o[g][l], full_t, seq_len, alpha, decay, threshold, ev[l]);
+                if (final_ewma) final_ewma[s + g * L + l] = f;
+            }
+        }
+    }
+}
+
+__attribute__((target("avx512f,avx2")))
+void ewma_batch_avx512(const double* data, size_t num_seqs, size_t seq_len,
+                       double alpha, double threshold, int* out,
+                       const double* init, double* final_ewma) {
+    size_t s = 0;
+    for (; s + 16 <= num_seqs; s += 16) avx512_groups<2>(data, s, seq_len, alpha, threshold, out, init, final_ewma);
+    for (; s + 8 <= num_seqs; s += 8) avx512_groups<1>(data, s, seq_len, alpha, threshold, out, init, final_ewma);
+    if (s < num_seqs) {
+        ewma_batch_avx2(data + s * seq_len, num_seqs - s, seq_len, alpha, threshold, out + s * seq_len,
+                        init ? init + s : nullptr, final_ewma ? final_ewma + s : nullptr);
+    }
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+BatchKernel detect_batch_kernel() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return BatchKernel::Avx512;
+    if (__builtin_cpu_supports("avx2")) return BatchKernel::Avx2;
+    return BatchKernel::Scalar;
+}
+
+#else // !FI_X86
+
+void ewma_batch_avx2(const double* data, size_t num_seqs, size_t seq_len, double alpha, double threshold, int* out,
+                     const double* init, double* final_ewma) {
+    ewma_batch_scalar(data, num_seqs, seq_len, alpha, threshold, out, init, final_ewma);
+}
+void ewma_batch_avx512(const double* data, size_t num_seqs, size_t seq_len, double alpha, double threshold, int* out,
+                       const double* init, double* final_ewma) {
+    ewma_batch_scalar(data, num_seqs, seq_len, alpha, threshold, out, init, final_ewma);
+}
+BatchKernel detect_batch_kernel() { return BatchKernel::Scalar; }
+
+#endif
+
+const char* batch_kernel_name(BatchKernel k) {
+    switch (k) {
+        case BatchKernel::Scalar: return "scalar";
+        case BatchKernel::Avx2: return "avx2";
+        case BatchKernel::Avx512: return "avx512";
+        default: return "auto";
+    }
+}
+
+void ewma_batch(BatchKernel k, const double* data, size_t num_seqs, size_t seq_len,
+                double alpha, double threshold, int* out,
+                const double* init, double* final_ewma) {
+    static const BatchKernel best = detect_batch_kernel();
+    if (k == BatchKernel::Auto || int(k) > int(best)) k = best;
+    switch (k) {
+        case BatchKernel::Avx512: ewma_batch_avx512(data, num_seqs, seq_len, alpha, threshold, out, init, final_ewma); break;
+        case BatchKernel::Avx2: ewma_batch_avx2(data, num_seqs, seq_len, alpha, threshold, out, init, final_ewma); break;
+        default: ewma_batch_scalar(data, num_seqs, seq_len, alpha, threshold, out, init, final_ewma); break;
+    }
+}
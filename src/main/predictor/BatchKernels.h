@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+
+/*
+ CPU kernels for Predictor::process_batch: independent EWMA + threshold
+ classification over `num_seqs` sequences of `seq_len` samples, laid out
+ sequence-major (data[s * seq_len + i]).
+
+ The vector kernels run one sequence per lane (4 with AVX2, 8 with AVX-512):
+ blocks of lanes x lanes samples are transposed in registers to time-major,
+ stepped, classified with compare masks (no branches) and transposed back for
+ the store. They use separate multiply and add (no FMA) in the same order as
+ the scalar loop, so all kernels produce bit-identical output. Leftover
+ sequences and samples fall back to the scalar recurrence.
+
+ Optional hooks for chunked scans (ParallelBatch.h): `init` gives each
+ sequence's starting EWMA (default 0), `final_ewma` receives its last value.
+*/
+
+enum class BatchKernel { Auto = 0, Scalar, Avx2, Avx512 };
+
+// best kernel the running CPU supports
+BatchKernel detect_batch_kernel();
+const char* batch_kernel_name(BatchKernel k);
+
+void ewma_batch_scalar(const double* data, size_t num_seqs, size_t seq_len,
+                       double alpha, double threshold, int* out,
+                       const double* init = nullptr, double* final_ewma = nullptr);
+// vector kernels; only call when detect_batch_kernel() reports support
+void ewma_batch_avx2(const double* data, size_t num_seqs, size_t seq_len,
+                     double alpha, double threshold, int* out,
+                     const double* init = nullptr, double* final_ewma = nullptr);
+void ewma_batch_avx512(const double* data, size_t num_seqs, size_t seq_len,
+                       double alpha, double threshold, int* out,
+                       const double* init = nullptr, double* final_ewma = nullptr);
+
+// dispatch; Auto resolves via detect_batch_kernel(), unsupported requests fall back
+void ewma_batch(BatchKernel k, const double* data, size_t num_seqs, size_t seq_len,
+                double alpha, double threshold, int* out,
+                const double* init = nullptr, double* final_ewma = nullptr);
@@ -0,0 +1,87 @@
+#include "ParallelBatch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "../pipeline/ThreadPool.h"
+
+namespace {
+
+// tasks per thread: enough slack for stealing to even out stragglers
+constexpr size_t TASKS_PER_THREAD = 4;
+// whole-sequence chunks are kept a multiple of the widest SIMD group
+constexpr size_t SEQ_GRAIN = 16;
+
+void split_sequences(ThreadPool& pool, BatchKernel k, const double* data, size_t num_seqs, size_t seq_len,
+                     double alpha, double threshold, int* out) {
+    size_t per = (num_seqs + pool.size() * TASKS_PER_THREAD - 1) / (pool.size() * TASKS_PER_THREAD);
+    per = (per + SEQ_GRAIN - 1) / SEQ_GRAIN * SEQ_GRAIN;
+    const size_t tasks = (num_seqs + per - 1) / per;
+    pool.parallel_for(tasks, [&](size_t t) {
+        size_t s0 = t * per;
+        size_t n = std::min(per, num_seqs - s0);
+        ewma_batch(k, data + s0 * seq_len, n, seq_len, alpha, threshold, out + s0 * seq_len);
+    });
+}
+
+// two-pass scan of one long sequence; `carry` is scratch of at least seq_len / chunk + 1
+void scan_sequence(ThreadPool& pool, BatchKernel k, const double* x, size_t seq_len, size_t chunk,
+                   double alpha, double threshold, int* o, std::vector<double>& carry) {
+    const size_t chunks = seq_len / chunk;  // full chunks; the remainder is finished serially
+    const size_t tail = seq_len - chunks * chunk;
+    size_t per = (chunks + pool.size() * TASKS_PER_THREAD - 1) / (pool.size() * TASKS_PER_THREAD);
+    per = std::max<size_t>(per, 1);
+    const size_t tasks = (chunks + per - 1) / per;
+    double* local = carry.data();
+    double* start = carry.data() + chunks;
+
+    // pass 1: local end values; classification output is discarded (overwritten by pass 2)
+    pool.parallel_for(tasks, [&](size_t t) {
+        size_t c0 = t * per;
+        size_t n = std::min(per, chunks - c0);
+        ewma_batch(k, x + c0 * chunk, n, chunk, alpha, threshold, o + c0 * chunk, nullptr, local + c0);
+    });
+
+    const double decay_k = std::pow(1.0 - alpha, double(chunk));
+    double e = 0.0;
+    for (size_t c = 0; c < chunks; ++c) {
+        start[c] = e;
+        e = local[c] + decay_k * e;
+    }
+
+    // pass 2: the true start of every chunk is known
+    pool.parallel_for(tasks, [&](size_t t) {
+        size_t c0 = t * per;
+        size_t n = std::min(per, chunks - c0);
+        ewma_batch(k, x + c0 * chunk, n, chunk, alpha, threshold, o + c0 * chunk, start + c0);
+    });
+
+    if (tail) ewma_batch(k, x + chunks * chunk, 1, tail, alpha, threshold, o + chunks * chunk, &e);
+}
+
+} // namespace
+
+void ewma_batch_parallel(ThreadPool& pool, BatchKernel k, const double* data, size_t num_seqs, size_t seq_len,
+                         double alpha, double threshold, int* out) {
+    if (k == BatchKernel::Auto) k = detect_batch_kernel();
+    const size_t threads = pool.size();
+
+    // enough independent sequences to keep every thread busy: no need to split in time
+    if (threads == 1 || num_seqs >= threads * SEQ_GRAIN || seq_len < 2 * PARALLEL_SCAN_MIN_CHUNK) {
+        if (threads == 1 || num_seqs <= SEQ_GRAIN) {
+            ewma_batch(k, data, num_seqs, seq_len, alpha, threshold, out);
+        } else {
+            split_sequences(pool, k, data, num_seqs, seq_len, alpha, threshold, out);
+        }
+        return;
+    }
+
+    // aim for a few SIMD groups of chunks per thread, but never below the minimum chunk
+    size_t chunk = seq_len / (threads * TASKS_PER_THREAD * SEQ_GRAIN);
+    chunk = std::max(chunk, PARALLEL_SCAN_MIN_CHUNK);
+    std::vector<double> carry(2 * (seq_len / chunk) + 1);
+    for (size_t s = 0; s < num_seqs; ++s) {
+        scan_sequence(pool, k, data + s * seq_len, seq_len, chunk, alpha, threshold, out + s * seq_len, carry);
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+
+#include "BatchKernels.h"
+
+class ThreadPool;
+
+/*
+ Multi-core driver for the batch EWMA kernels (same layout and contract as
+ ewma_batch):
+ - enough sequences: they are cut into chunks of whole sequences and the
+   chunks spread over the pool; output is bit-identical to ewma_batch
+ - few, long sequences: each sequence is cut into equal time chunks and
+   scanned in two passes. The EWMA is linear, so a chunk of k samples
+   started from e_in ends at  local + (1 - alpha)^k * e_in , where `local`
+   is the same chunk started from 0.
+     pass 1 (parallel)  local end value of every chunk, from 0
+     carry  (serial)    e_in of chunk c+1 = local_c + (1 - alpha)^k * e_in_c
+     pass 2 (parallel)  rescan every chunk from its e_in and classify
+   The chunks of one sequence are themselves laid out like a batch of
+   sequences, so both passes run on the SIMD kernels. The carried start
+   values are only equal to the serial ones up to rounding: every step
+   rounds by at most an ulp of the largest |sample| and the recurrence
+   forgets it at rate alpha, so the two paths stay within
+   PARALLEL_SCAN_ULP_MARGIN / alpha of those ulps. Only a sample whose
+   serial EWMA sits that close to +/-threshold may classify differently.
+*/
+
+// sequences shorter than this are never split in time
+constexpr size_t PARALLEL_SCAN_MIN_CHUNK = 4096;
+// two-pass scan tolerance, in ulp of the largest |sample| per 1 / alpha (see above)
+constexpr double PARALLEL_SCAN_ULP_MARGIN = 8.0;
+
+void ewma_batch_parallel(ThreadPool& pool, BatchKernel k, const double* data, size_t num_seqs, size_t seq_len,
+                         double alpha, double threshold, int* out);
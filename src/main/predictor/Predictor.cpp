@@ -1,6 +1,10 @@
 #include "Predictor.h"
 #include <iostream>
 #include <cstring>
+#include <thread>
+
+#include "ParallelBatch.h"
+#include "../pipeline/ThreadPool.h"
 
 Predictor::Predictor(double alpha, double threshold, Mode mode)
     : alpha_(alpha), threshold_(threshold), ewma_(0.0), mode_(mode) {
@@ -14,12 +18,18 @@ Predictor::Predictor(double alpha, double threshold, Mode mode)
 #endif
 }
 
+Predictor::~Predictor() = default;
+
+void Predictor::set_batch_threads(size_t n) {
+    if (n == 0) n = std::thread::hardware_concurrency();
+    if (n == 0) n = 1;
+    if (n != batch_threads_) pool_.reset();
+    batch_threads_ = n;
+}
+
 int Predictor::process_sample(double ofi) {
     std::lock_guard<std::mutex> lk(mtx_);
-    ewma_ = alpha_ * ofi + (1.0 - alpha_) * ewma_;
-    if (ewma_ > threshold_) return 1;
-    if (ewma_ < -threshold_) return -1;
-    return 0;
+    return step(ewma_, alpha_, threshold_, ofi);
 }
 
 double Predictor::get_ewma() const {
@@ -140,19 +150,13 @@ bool Predictor::process_batch(const std::vector<double>& data, size_t num_seqs,
         // if OpenCL not available, fallthrough to CPU
     }
 
-    // CPU fallback: treat each sequence independently, do sequential EWMA per sequence
-    for (size_t s = 0; s < num_seqs; ++s) {
-        double local_ewma = 0.0; // independent sequences start from 0 by contract
-        size_t base = s * seq_len;
-        for (size_t i = 0; i < seq_len; ++i) {
-            double x = data[base + i];
-            local_ewma = alpha_ * x + (1.0 - alpha_) * local_ewma;
-            int pred = 0;
-            if (local_ewma > threshold_) pred = 1;
-            else if (local_ewma < -threshold_) pred = -1;
-            out[base + i] = pred;
-        }
+    // CPU fallback: each sequence independently from 0; vectorised across sequences when the CPU allows
+    if (batch_threads_ > 1) {
+        if (!pool_) pool_.reset(new ThreadPool(batch_threads_));
+        ewma_batch_parallel(*pool_, batch_kernel_, data.data(), num_seqs, seq_len, alpha_, threshold_, out.data());
+        return true;
     }
+    ewma_batch(batch_kernel_, data.data(), num_seqs, seq_len, alpha_, threshold_, out.data());
     return true;
 }
 
@@ -1,9 +1,15 @@
 #pragma once
+#include <cstddef>
 #include <cstdint>
 #include <deque>
+#include <memory>
 #include <mutex>
 #include <vector>
 
+#include "BatchKernels.h"
+
+class ThreadPool;
+
 // Optional OpenCL support is enabled via CMake option BUILD_WITH_OPENCL
 #ifdef BUILD_WITH_OPENCL
 #include <CL/cl.h>
@@ -20,10 +26,30 @@ public:
     enum class Mode { CPU = 0, GPU };
 
     Predictor(double alpha = 0.2, double threshold = 50.0, Mode mode = Mode::CPU);
+    ~Predictor();
     // process single OFI sample; returns action: 1=BUY, -1=SELL, 0=HOLD
     int process_sample(double ofi);
+    // same without taking the mutex, for a caller that owns the predictor on one thread
+    int process_sample_unlocked(double ofi) { return step(ewma_, alpha_, threshold_, ofi); }
     double get_ewma() const;
 
+    // one EWMA update + threshold classification on caller-owned state.
+    // shared by process_sample and per-symbol state (SymbolStore)
+    static int step(double& ewma, double alpha, double threshold, double ofi) {
+        ewma = alpha * ofi + (1.0 - alpha) * ewma;
+        if (ewma > threshold) return 1;
+        if (ewma < -threshold) return -1;
+        return 0;
+    }
+
+    // weighted sum of a feature vector (features/FeatureEngine.h): the sample that
+    // step / process_sample consume in place of a raw OFI value
+    static double feature_sample(const double* x, const double* w, size_t n) {
+        double v = 0.0;
+        for (size_t i = 0; i < n; ++i) v += w[i] * x[i];
+        return v;
+    }
+
     // process a batch of data that contains multiple independent sequences.
     // Input layout: concatenated sequences, each of length `seq_len`.
     // `data.size()` must be `num_seqs * seq_len`.
@@ -31,10 +57,22 @@ public:
     // GPU mode will attempt to run using OpenCL if available; otherwise falls back to CPU.
     bool process_batch(const std::vector<double>& data, size_t num_seqs, size_t seq_len, std::vector<int>& out);
 
+    // CPU kernel for process_batch; Auto picks the widest SIMD the CPU supports.
+    // all kernels give bit-identical results
+    void set_batch_kernel(BatchKernel k) { batch_kernel_ = k; }
+    BatchKernel get_batch_kernel() const { return batch_kernel_; }
+    // CPU threads used by process_batch (default 1; 0 = all cores). With more than
+    // one thread, few long sequences are split in time (see ParallelBatch.h), which
+    // matches the serial result only up to rounding
+    void set_batch_threads(size_t n);
+    size_t get_batch_threads() const { return batch_threads_; }
+
     // change runtime mode; if GPU requested but not available, remains CPU
     void set_mode(Mode m);
     // query current configured mode
     Mode get_mode() const;
+    double get_alpha() const { return alpha_; }
+    double get_threshold() const { return threshold_; }
     // whether GPU (OpenCL) path is available at runtime
     bool gpu_available() const;
 
@@ -44,6 +82,9 @@ private:
     double ewma_;
     mutable std::mutex mtx_;
     Mode mode_;
+    BatchKernel batch_kernel_ = BatchKernel::Auto;
+    size_t batch_threads_ = 1;
+    std::unique_ptr<ThreadPool> pool_;  // created on first multi-threaded batch
 
 #ifdef BUILD_WITH_OPENCL
     // OpenCL runtime handles
@@ -0,0 +1,210 @@
+#include "PredictorBank.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define FI_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// `v` or `first:last:step`; fills `vals`, false if malformed
+bool parse_column(const std::string& tok, std::vector<double>& vals) {
+    auto num = [](const std::string& s, double& v) {
+        char* end = nullptr;
+        v = std::strtod(s.c_str(), &end);
+        return !s.empty() && end && *end == '\0' && std::isfinite(v);
+    };
+    vals.clear();
+    size_t c1 = tok.find(':');
+    if (c1 == std::string::npos) {
+        double v;
+        if (!num(tok, v)) return false;
+        vals.push_back(v);
+        return true;
+    }
+    size_t c2 = tok.find(':', c1 + 1);
+    if (c2 == std::string::npos) return false;
+    double first, last, step;
+    if (!num(tok.substr(0, c1), first) || !num(tok.substr(c1 + 1, c2 - c1 - 1), last) ||
+        !num(tok.substr(c2 + 1), step) || step <= 0.0 || last < first) {
+        return false;
+    }
+    // index-based so rounding cannot add or lose the last point
+    size_t count = size_t(std::floor((last - first) / step + 1e-9)) + 1;
+    if (count > 100000) return false;
+    for (size_t k = 0; k < count; ++k) vals.push_back(first + double(k) * step);
+    return true;
+}
+
+int vote(const std::vector<uint64_t>& buy, const std::vector<uint64_t>& sell) {
+    int v = 0;
+    for (size_t w = 0; w < buy.size(); ++w) v += __builtin_popcountll(buy[w]) - __builtin_popcountll(sell[w]);
+    return v;
+}
+
+struct Row {
+    const double* alpha;
+    const double* decay;
+    const double* thr;
+    const double* neg_thr;
+    double* ewma;
+    int64_t* buy_ticks;
+    int64_t* sell_ticks;
+    uint64_t* buy;
+    uint64_t* sell;
+};
+
+void update_scalar(const Row& r, size_t stride, double ofi) {
+    for (size_t i = 0; i < stride; ++i) {
+        double e = r.alpha[i] * ofi + r.decay[i] * r.ewma[i];
+        r.ewma[i] = e;
+        if (e > r.thr[i]) {
+            r.buy[i >> 6] |= uint64_t(1) << (i & 63);
+            ++r.buy_ticks[i];
+        } else if (e < r.neg_thr[i]) {
+            r.sell[i >> 6] |= uint64_t(1) << (i & 63);
+            ++r.sell_ticks[i];
+        }
+    }
+}
+
+#ifdef FI_X86
+
+__attribute__((target("avx2")))
+void update_avx2(const Row& r, size_t stride, double ofi) {
+    const __m256d x = _mm256_set1_pd(ofi);
+    for (size_t i = 0; i < stride; i += 4) {
+        __m256d e = _mm256_add_pd(_mm256_mul_pd(_mm256_loadu_pd(r.alpha + i), x),
+                                  _mm256_mul_pd(_mm256_loadu_pd(r.decay + i), _mm256_loadu_pd(r.ewma + i)));
+        _mm256_storeu_pd(r.ewma + i, e);
+        __m256d b = _mm256_cmp_pd(e, _mm256_loadu_pd(r.thr + i), _CMP_GT_OQ);
+        __m256d s = _mm256_cmp_pd(e, _mm256_loadu_pd(r.neg_thr + i), _CMP_LT_OQ);
+        // all-ones lanes are -1 as int64: subtracting counts them
+        __m256i* bt = reinterpret_cast<__m256i*>(r.buy_ticks + i);
+        __m256i* st = reinterpret_cast<__m256i*>(r.sell_ticks + i);
+        _mm256_storeu_si256(bt, _mm256_sub_epi64(_mm256_loadu_si256(bt), _mm256_castpd_si256(b)));
+        _mm256_storeu_si256(st, _mm256_sub_epi64(_mm256_loadu_si256(st), _mm256_castpd_si256(s)));
+        r.buy[i >> 6] |= uint64_t(_mm256_movemask_pd(b)) << (i & 63);
+        r.sell[i >> 6] |= uint64_t(_mm256_movemask_pd(s)) << (i & 63);
+    }
+}
+
+// see BatchKernels.cpp: GCC 12 false positive inside the AVX-512 intrinsic headers
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+__attribute__((target("avx512f")))
+void update_avx512(const Row& r, size_t stride, double ofi) {
+    const __m512d x = _mm512_set1_pd(ofi);
+    const __m512i one = _mm512_set1_epi64(1);
+    for (size_t i = 0; i < stride; i += 8) {
+        __m512d e = _mm512_add_pd(_mm512_mul_pd(_mm512_loadu_pd(r.alpha + i), x),
+                                  _mm512_mul_pd(_mm512_loadu_pd(r.decay + i), _mm512_loadu_pd(r.ewma + i)));
+        _mm512_storeu_pd(r.ewma + i, e);
+        __mmask8 b = _mm512_cmp_pd_mask(e, _mm512_loadu_pd(r.thr + i), _CMP_GT_OQ);
+        __mmask8 s = _mm512_cmp_pd_mask(e, _mm512_loadu_pd(r.neg_thr + i), _CMP_LT_OQ);
+        __m512i bt = _mm512_loadu_si512(r.buy_ticks + i);
+        __m512i st = _mm512_loadu_si512(r.sell_ticks + i);
+        _mm512_storeu_si512(r.buy_ticks + i, _mm512_mask_add_epi64(bt, b, bt, one));
+        _mm512_storeu_si512(r.sell_ticks + i, _mm512_mask_add_epi64(st, s, st, one));
+        r.buy[i >> 6] |= uint64_t(b) << (i & 63);
+        r.sell[i >> 6] |= uint64_t(s) << (i & 63);
+    }
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif // FI_X86
+
+} // namespace
+
+bool load_bank_configs(const std::string& path, std::vector<BankConfig>& out, std::string& err) {
+    std::ifstream in(path);
+    if (!in) {
+        err = path + ": cannot open";
+        return false;
+    }
+    out.clear();
+    std::string line;
+    std::vector<double> alphas, thresholds;
+    for (int lineno = 1; std::getline(in, line); ++lineno) {
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.resize(hash);
+        std::istringstream ls(line);
+        std::string a, t, extra;
+        if (!(ls >> a)) continue;  // blank or comment
+        auto fail = [&](const char* what) {
+            err = path + ":" + std::to_string(lineno) + ": " + what;
+            return false;
+        };
+        if (!(ls >> t) || (ls >> extra)) return fail("expected `alpha threshold`");
+        if (!parse_column(a, alphas) || !parse_column(t, thresholds)) return fail("bad number or range");
+        for (double av : alphas) {
+            if (!(av > 0.0 && av <= 1.0)) return fail("alpha must be in (0, 1]");
+            for (double tv : thresholds) {
+                if (!(tv >= 0.0)) return fail("threshold must be >= 0");
+                out.push_back({av, tv});
+            }
+        }
+    }
+    if (out.empty()) {
+        err = path + ": no configurations";
+        return false;
+    }
+    return true;
+}
+
+PredictorBank::PredictorBank(const std::vector<BankConfig>& configs, size_t symbols)
+    : n_(configs.size()),
+      stride_((configs.size() + LANES - 1) / LANES * LANES),
+      configs_(configs),
+      // padding lanes: alpha 0 keeps their EWMA at 0, an infinite threshold never fires
+      alpha_(stride_, 0.0),
+      decay_(stride_, 1.0),
+      thr_(stride_, std::numeric_limits<double>::infinity()),
+      neg_thr_(stride_, -std::numeric_limits<double>::infinity()),
+      ewma_(symbols * stride_, 0.0),
+      buy_ticks_(stride_, 0),
+      sell_ticks_(stride_, 0),
+      buy_((stride_ + 63) / 64, 0),
+      sell_((stride_ + 63) / 64, 0) {
+    for (size_t i = 0; i < n_; ++i) {
+        alpha_[i] = configs[i].alpha;
+        decay_[i] = 1.0 - configs[i].alpha;  // the value Predictor::step computes inline
+        thr_[i] = configs[i].threshold;
+        neg_thr_[i] = -configs[i].threshold;
+    }
+    set_kernel(BatchKernel::Auto);
+}
+
+void PredictorBank::set_kernel(BatchKernel k) {
+    const BatchKernel best = detect_batch_kernel();
+    if (k == BatchKernel::Auto || int(k) > int(best)) k = best;
+    kernel_ = k;
+}
+
+int PredictorBank::update(uint32_t symbol, double ofi) {
+    std::memset(buy_.data(), 0, buy_.size() * sizeof(uint64_t));
+    std::memset(sell_.data(), 0, sell_.size() * sizeof(uint64_t));
+    Row r{alpha_.data(), decay_.data(), thr_.data(), neg_thr_.data(), ewma_.data() + size_t(symbol) * stride_,
+          buy_ticks_.data(), sell_ticks_.data(), buy_.data(), sell_.data()};
+    switch (kernel_) {
+#ifdef FI_X86
+        case BatchKernel::Avx512: update_avx512(r, stride_, ofi); break;
+        case BatchKernel::Avx2: update_avx2(r, stride_, ofi); break;
+#endif
+        default: update_scalar(r, stride_, ofi); break;
+    }
+    return vote(buy_, sell_);
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "BatchKernels.h"
+
+/*
+ Bank of N predictor configurations evaluated side by side on the main
+ predictor's input (raw OFI, or the --feature-weights sample).
+ - configurations are stored structure-of-arrays (alpha, 1 - alpha, threshold,
+   -threshold), padded to a multiple of 8 with inert entries
+ - each symbol owns one row of N EWMAs; all rows live in one flat array
+   allocated up front
+ - update() steps every EWMA of the symbol's row with Predictor::step's
+   arithmetic (separate multiply and add, same order) and packs the result into
+   two bitmasks: bit i of buy_mask()/sell_mask() = config i says BUY/SELL
+ - AVX2 / AVX-512 kernels step 4 / 8 configurations per instruction and turn
+   compare results straight into mask bits; results are bit-identical to the
+   scalar loop and to a standalone Predictor with the same parameters
+ - per-config counters of BUY/SELL ticks (summed over symbols) are kept in the
+   same pass, for ranking parameterisations after a run
+*/
+
+struct BankConfig {
+    double alpha;
+    double threshold;
+};
+
+// Parse a bank file: one `alpha threshold` pair per line, '#' starts a comment.
+// Either column may be a range `first:last:step`, expanding to every combination,
+// e.g. `0.01:0.16:0.01 10:160:10` is a 16 x 16 grid. Returns false and sets `err`
+// (with the line number) on a malformed line or out-of-range value.
+bool load_bank_configs(const std::string& path, std::vector<BankConfig>& out, std::string& err);
+
+class PredictorBank {
+public:
+    static constexpr size_t LANES = 8;
+
+    PredictorBank(const std::vector<BankConfig>& configs, size_t symbols);
+
+    // step all configurations for `symbol`; returns the ensemble vote
+    // (number of configs saying BUY minus number saying SELL)
+    int update(uint32_t symbol, double ofi);
+
+    // masks of the last update(): words() 64-bit words, bit i = config i
+    const uint64_t* buy_mask() const { return buy_.data(); }
+    const uint64_t* sell_mask() const { return sell_.data(); }
+    size_t words() const { return buy_.size(); }
+
+    size_t size() const { return n_; }
+    const BankConfig& config(size_t i) const { return configs_[i]; }
+    double ewma(uint32_t symbol, size_t i) const { return ewma_[size_t(symbol) * stride_ + i]; }
+    // ticks on which config i signalled BUY / SELL, over all symbols
+    uint64_t buy_ticks(size_t i) const { return buy_ticks_[i]; }
+    uint64_t sell_ticks(size_t i) const { return sell_ticks_[i]; }
+
+    // Auto (default) picks the widest SIMD the CPU supports
+    void set_kernel(BatchKernel k);
+    BatchKernel kernel() const { return kernel_; }
+
+private:
+    size_t n_;
+    size_t stride_;  // n_ rounded up to LANES
+    std::vector<BankConfig> configs_;
+    std::vector<double> alpha_;
+    std::vector<double> decay_;
+    std::vector<double> thr_;
+    std::vector<double> neg_thr_;
+    std::vector<double> ewma_;          // symbols x stride_
+    std::vector<int64_t> buy_ticks_;    // stride_ entries; int64 so SIMD can subtract compare masks
+    std::vector<int64_t> sell_ticks_;
+    std::vector<uint64_t> buy_;
+    std::vector<uint64_t> sell_;
+    BatchKernel kernel_ = BatchKernel::Scalar;
+};
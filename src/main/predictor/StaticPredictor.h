@@ -0,0 +1,167 @@
+#pragma once
+#include <cstdint>
+
+/*
+ Compile-time specialised predictor: alpha, threshold and the number
+ representation are template parameters, so step() compiles to a handful of
+ instructions with the constants folded in and inlines into the tick loop.
+ No mutex, no runtime parameters.
+ - EwmaDouble: the arithmetic of Predictor::step, operation for operation;
+   decisions and EWMAs are bit-identical to the runtime predictor
+ - EwmaFloat: the same formula in single precision
+ - EwmaFixed<F>: Q-format in int64 with F fractional bits. The input is
+   rounded to the nearest 2^-F: exact for raw OFI, which is integral
+   (sizes), within 2^-(F+1) for a weighted feature sum (--feature-weights);
+   the update is ewma += round(alpha * (ofi - ewma)) with alpha quantised
+   to F bits
+ Tolerance against the double predictor: the EWMA is a contraction, so
+ rounding does not accumulate beyond a few ulp / alpha, and the quantised
+ alpha (relative error <= 2^-(F+1) / alpha) shifts the EWMA by that fraction
+ of its recent excursion. With M = largest |OFI| over the last ~1/alpha
+ ticks, the EWMA differs from the double one by at most
+   float:     1e-6 * M
+   Q16 fixed: 1e-4 * M + 2^-16
+ and a decision can only differ when the double EWMA is that close to
+ +-threshold. flow_imbalance_bench (predictor/static/.../agreement) measures
+ it: with N(0, 300) integral OFI, float is ~8e-8 * M with no mismatches over
+ 1e7 ticks, and Q16 is ~9e-6 * M with ~1.5e-5 of decisions flipped, all
+ within 0.005 of the threshold.
+ Fixed-point range: inputs saturate at +-2^(62 - F) (about 7e13 for F = 16)
+ and NaN reads as 0, so any double is safe (feature-weighted sums are not
+ bounded). The EWMA stays between its old value and the input, so
+ x - ewma fits int64; its product with alpha is taken in 128 bits.
+*/
+
+struct EwmaDouble {
+    using type = double;
+};
+
+struct EwmaFloat {
+    using type = float;
+};
+
+template <int FracBits>
+struct EwmaFixed {
+    static_assert(FracBits > 0 && FracBits < 31, "Q format needs 1..30 fractional bits");
+    using type = int64_t;
+    static constexpr int FRAC_BITS = FracBits;
+    static constexpr int64_t ONE = int64_t(1) << FracBits;
+    // saturation bound in Q units: differences of two in-range values still fit int64
+    static constexpr int64_t MAX = int64_t(1) << 62;
+    // round to nearest, saturating at +-MAX, NaN -> 0; constexpr, unlike std::llround.
+    // the conversion is undefined for out-of-range doubles, hence the explicit checks
+    static constexpr int64_t from_double(double x) {
+        constexpr double LIMIT = double(MAX >> FracBits);
+        x = x != x ? 0.0 : x < -LIMIT ? -LIMIT : x > LIMIT ? LIMIT : x;
+        return int64_t(x * double(ONE) + (x >= 0.0 ? 0.5 : -0.5));
+    }
+};
+
+template <typename Rep, double Alpha, double Threshold>
+class StaticPredictor;
+
+template <double Alpha, double Threshold>
+class StaticPredictor<EwmaDouble, Alpha, Threshold> {
+    static_assert(Alpha > 0.0 && Alpha <= 1.0, "alpha must be in (0, 1]");
+
+public:
+    using state_type = double;
+    static constexpr double alpha = Alpha;
+    static constexpr double threshold = Threshold;
+
+    static int step(state_type& ewma, double ofi) {
+        ewma = Alpha * ofi + (1.0 - Alpha) * ewma;
+        if (ewma > Threshold) return 1;
+        if (ewma < -Threshold) return -1;
+        return 0;
+    }
+    static double to_double(state_type s) { return s; }
+
+    int process_sample(double ofi) { return step(ewma_, ofi); }
+    double get_ewma() const { return ewma_; }
+
+private:
+    state_type ewma_ = 0.0;
+};
+
+template <double Alpha, double Threshold>
+class StaticPredictor<EwmaFloat, Alpha, Threshold> {
+    static_assert(Alpha > 0.0 && Alpha <= 1.0, "alpha must be in (0, 1]");
+    static constexpr float A = float(Alpha);
+    static constexpr float DECAY = float(1.0 - Alpha);
+    static constexpr float THR = float(Threshold);
+
+public:
+    using state_type = float;
+    static constexpr double alpha = Alpha;
+    static constexpr double threshold = Threshold;
+
+    static int step(state_type& ewma, double ofi) {
+        ewma = A * float(ofi) + DECAY * ewma;
+        if (ewma > THR) return 1;
+        if (ewma < -THR) return -1;
+        return 0;
+    }
+    static double to_double(state_type s) { return double(s); }
+
+    int process_sample(double ofi) { return step(ewma_, ofi); }
+    double get_ewma() const { return double(ewma_); }
+
+private:
+    state_type ewma_ = 0.0f;
+};
+
+template <int F, double Alpha, double Threshold>
+class StaticPredictor<EwmaFixed<F>, Alpha, Threshold> {
+    using Q = EwmaFixed<F>;
+    static_assert(Alpha > 0.0 && Alpha <= 1.0, "alpha must be in (0, 1]");
+    static constexpr int64_t ALPHA_Q = Q::from_double(Alpha);
+    static_assert(ALPHA_Q > 0, "alpha is below the Q format's resolution");
+    static constexpr int64_t THR_Q = Q::from_double(Threshold);
+    static constexpr int64_t HALF = int64_t(1) << (F - 1);
+
+public:
+    using state_type = int64_t;
+    static constexpr double alpha = Alpha;
+    static constexpr double threshold = Threshold;
+
+    static int step(state_type& ewma, double ofi) {
+        // round, not truncate: feature-weighted inputs are not integral
+        const int64_t x = Q::from_double(ofi);
+        // arithmetic shift of the rounded product: round half up. (x - ewma) * ALPHA_Q needs up
+        // to 63 + F bits; one 64x64->128 multiply
+        __extension__ using wide = __int128;
+        ewma += int64_t((wide(x - ewma) * ALPHA_Q + HALF) >> F);
+        if (ewma > THR_Q) return 1;
+        if (ewma < -THR_Q) return -1;
+        return 0;
+    }
+    static double to_double(state_type s) { return double(s) / double(Q::ONE); }
+
+    int process_sample(double ofi) { return step(ewma_, ofi); }
+    double get_ewma() const { return to_double(ewma_); }
+
+private:
+    state_type ewma_ = 0;
+};
+
+// the engine's fixed parameters; main's runtime Predictor uses the same values
+inline constexpr double ENGINE_ALPHA = 0.15;
+inline constexpr double ENGINE_THRESHOLD = 40.0;
+inline constexpr int ENGINE_Q_BITS = 16;
+
+// numeric path of SymbolStore::process_sample (--predictor=)
+enum class PredictorKind { Runtime = 0, StaticDouble, StaticFloat, StaticFixed };
+
+using EngineStaticDouble = StaticPredictor<EwmaDouble, ENGINE_ALPHA, ENGINE_THRESHOLD>;
+using EngineStaticFloat = StaticPredictor<EwmaFloat, ENGINE_ALPHA, ENGINE_THRESHOLD>;
+using EngineStaticFixed = StaticPredictor<EwmaFixed<ENGINE_Q_BITS>, ENGINE_ALPHA, ENGINE_THRESHOLD>;
+
+inline const char* predictor_kind_name(PredictorKind k) {
+    switch (k) {
+        case PredictorKind::StaticDouble: return "static-double";
+        case PredictorKind::StaticFloat: return "static-float";
+        case PredictorKind::StaticFixed: return "static-fixed-q16";
+        default: return "runtime";
+    }
+}
@@ -0,0 +1,176 @@
+#include "LowLatency.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include "../ingest/UdpIngest.h"
+#include "../ingest/UdpSocket.h"
+
+namespace {
+
+// stack the hot path may touch; faulted in once so later calls never fault
+constexpr size_t PREFAULT_STACK = 256 * 1024;
+
+__attribute__((noinline)) void prefault_stack() {
+    char stack[PREFAULT_STACK];
+    std::memset(stack, 0, sizeof(stack));
+    // keep the writes: the compiler must assume the buffer is read
+    asm volatile("" : : "r"(stack) : "memory");
+}
+
+} // namespace
+
+void TuningReport::add(const std::string& item, bool ok, const std::string& detail) {
+    entries_.push_back({item, ok, detail});
+}
+
+void TuningReport::print(std::ostream& os) const {
+    for (const Entry& e : entries_) {
+        os << "LOWLAT " << e.item << " " << (e.ok ? "ok" : "FAILED");
+        if (!e.detail.empty()) os << " " << e.detail;
+        os << "\n";
+    }
+}
+
+bool pin_current_thread(int cpu, std::string& err) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (rc != 0) {
+        err = std::strerror(rc);
+        return false;
+    }
+    return true;
+}
+
+bool set_fifo_priority(int priority, std::string& err) {
+    sched_param sp;
+    std::memset(&sp, 0, sizeof(sp));
+    sp.sched_priority = priority;
+    int rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp);
+    if (rc != 0) {
+        err = std::strerror(rc);
+        if (rc == EPERM) err += " (needs CAP_SYS_NICE or RLIMIT_RTPRIO)";
+        return false;
+    }
+    return true;
+}
+
+bool set_socket_busy_poll(int sock, int us, std::string& err) {
+    if (setsockopt(sock, SOL_SOCKET, SO_BUSY_POLL, &us, sizeof(us)) != 0) {
+        err = std::strerror(errno);
+        if (errno == EPERM) err += " (raising it needs CAP_NET_ADMIN)";
+        return false;
+    }
+    return true;
+}
+
+void apply_socket_tuning(int sock, const LowLatencyConfig& cfg, TuningReport& report) {
+    if (cfg.busy_poll) report.add("receive", true, "busy-poll (MSG_DONTWAIT spin)");
+    if (cfg.busy_poll_us <= 0) return;
+    std::string err;
+    bool ok = set_socket_busy_poll(sock, cfg.busy_poll_us, err);
+    report.add("SO_BUSY_POLL", ok, std::to_string(cfg.busy_poll_us) + "us" + (ok ? "" : ": " + err));
+}
+
+void apply_thread_tuning(const LowLatencyConfig& cfg, TuningReport& report) {
+    std::string err;
+    if (cfg.cpu >= 0) {
+        bool ok = pin_current_thread(cfg.cpu, err);
+        report.add("pin", ok, "cpu=" + std::to_string(cfg.cpu) + (ok ? "" : ": " + err));
+    }
+    if (cfg.fifo_priority > 0) {
+        bool ok = set_fifo_priority(cfg.fifo_priority, err);
+        report.add("SCHED_FIFO", ok, "priority=" + std::to_string(cfg.fifo_priority) + (ok ? "" : ": " + err));
+    }
+}
+
+void apply_process_tuning(const LowLatencyConfig& cfg, TuningReport& report) {
+    if (!cfg.lock_memory) return;
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        std::string detail = std::strerror(errno);
+        rlimit rl;
+        if (errno == ENOMEM && getrlimit(RLIMIT_MEMLOCK, &rl) == 0 && rl.rlim_cur != RLIM_INFINITY) {
+            detail += " (RLIMIT_MEMLOCK=" + std::to_string(rl.rlim_cur / 1024) + " KiB)";
+        }
+        report.add("mlockall", false, detail);
+        return;
+    }
+    prefault_stack();
+    report.add("mlockall", true, "current+future, stack prefaulted " + std::to_string(PREFAULT_STACK / 1024) + " KiB");
+}
+
+bool sample_receive_jitter(bool busy_poll, const LowLatencyConfig& cfg, size_t count, double rate_hz,
+                           LatencyHistogram& out, std::string& err) {
+    using clock = std::chrono::steady_clock;
+    int rx = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t alen = sizeof(addr);
+    if (rx < 0 || bind(rx, (sockaddr*)&addr, sizeof(addr)) < 0 || getsockname(rx, (sockaddr*)&addr, &alen) < 0) {
+        err = std::string("probe socket: ") + std::strerror(errno);
+        if (rx >= 0) close(rx);
+        return false;
+    }
+    // the receive loop wakes up to notice the end of the run
+    set_receive_timeout(rx, 0.2);
+    // a refused SO_BUSY_POLL is already in the LOWLAT report of the real socket
+    std::string ignored;
+    if (busy_poll && cfg.busy_poll_us > 0) set_socket_busy_poll(rx, cfg.busy_poll_us, ignored);
+
+    UdpIngest ingest(rx, 64, 64, UdpIngest::TimestampMode::KernelNs);
+    if (!ingest.init()) {
+        err = "kernel receive timestamps refused";
+        close(rx);
+        return false;
+    }
+    ingest.set_busy_poll(busy_poll);
+
+    std::atomic<bool> sent_all{false};
+    std::thread sender([&] {
+        int tx = socket(AF_INET, SOCK_DGRAM, 0);
+        connect(tx, (sockaddr*)&addr, sizeof(addr));
+        const char payload[] = "jitter";
+        const double interval = rate_hz > 0.0 ? 1.0 / rate_hz : 0.0;
+        auto start = clock::now();
+        for (size_t k = 0; k < count; ++k) {
+            auto due = start + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(double(k) * interval));
+            // yield rather than spin, so a busy-polling receiver sharing the core still runs
+            while (clock::now() < due) std::this_thread::yield();
+            send(tx, payload, sizeof(payload) - 1, 0);
+        }
+        close(tx);
+        sent_all.store(true, std::memory_order_release);
+    });
+
+    uint64_t received = 0;
+    auto last_data = clock::now();
+    while (received < count) {
+        int got = ingest.receive_batch();
+        if (got > 0) {
+            received += uint64_t(got);
+            last_data = clock::now();
+        } else if (sent_all.load(std::memory_order_acquire) && clock::now() - last_data > std::chrono::milliseconds(600)) {
+            break;  // the rest was lost
+        }
+    }
+    sender.join();
+    close(rx);
+    out = ingest.kernel_to_user_ns();
+    return true;
+}
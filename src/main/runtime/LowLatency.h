@@ -0,0 +1,72 @@
+#pragma once
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "../stats/LatencyHistogram.h"
+
+/*
+ Low-jitter runtime profile for the hot receive thread (--low-latency).
+ - busy poll: the socket is read with MSG_DONTWAIT in a spin loop, so a
+   datagram is picked up without a scheduler wakeup; optionally SO_BUSY_POLL
+   lets the kernel poll the device queue inside the receive call as well
+ - the hot thread is pinned to one CPU and may run SCHED_FIFO
+ - mlockall(MCL_CURRENT | MCL_FUTURE) plus a pre-touched stack keep page
+   faults off the hot path
+ Every step records whether it took effect in a TuningReport printed at
+ startup; refusals (no CAP_SYS_NICE, RLIMIT_MEMLOCK, ...) are reported, not
+ fatal. Spinning needs a core of its own: on a shared core it steals time
+ from the threads it is waiting for.
+ --jitter-compare measures what the profile buys before any real traffic:
+ a private loopback socket with kernel receive timestamps is fed at a fixed
+ rate and read once blocking and once busy polling, on the tuned thread.
+*/
+
+struct LowLatencyConfig {
+    bool busy_poll = false;
+    // SO_BUSY_POLL budget in microseconds, 0 = leave unset
+    int busy_poll_us = 0;
+    // CPU for the hot thread, -1 = leave unpinned
+    int cpu = -1;
+    bool lock_memory = false;
+    // SCHED_FIFO priority for the hot thread (1..99), 0 = normal scheduling
+    int fifo_priority = 0;
+    // datagrams per receive mode in the startup jitter probe, 0 = no probe
+    size_t jitter_samples = 0;
+};
+
+class TuningReport {
+public:
+    void add(const std::string& item, bool ok, const std::string& detail);
+    // one `LOWLAT <item> ok|FAILED <detail>` line per step
+    void print(std::ostream& os) const;
+    bool empty() const { return entries_.empty(); }
+
+private:
+    struct Entry {
+        std::string item;
+        bool ok;
+        std::string detail;
+    };
+    std::vector<Entry> entries_;
+};
+
+// calling thread only; on failure `err` says why
+bool pin_current_thread(int cpu, std::string& err);
+bool set_fifo_priority(int priority, std::string& err);
+// SO_BUSY_POLL budget in microseconds
+bool set_socket_busy_poll(int sock, int us, std::string& err);
+
+// SO_BUSY_POLL on `sock` (busy_poll_us > 0)
+void apply_socket_tuning(int sock, const LowLatencyConfig& cfg, TuningReport& report);
+// pinning and scheduling of the calling thread
+void apply_thread_tuning(const LowLatencyConfig& cfg, TuningReport& report);
+// mlockall and stack pre-fault; process wide
+void apply_process_tuning(const LowLatencyConfig& cfg, TuningReport& report);
+
+// startup probe: a helper thread sends `count` datagrams at `rate_hz` to a private loopback
+// socket and the calling thread receives them, blocking or busy polling (with SO_BUSY_POLL
+// when cfg.busy_poll_us > 0). `out` gets kernel receive timestamp -> user space in ns.
+// false if the socket or kernel timestamps are refused; `err` says why
+bool sample_receive_jitter(bool busy_poll, const LowLatencyConfig& cfg, size_t count, double rate_hz,
+                           LatencyHistogram& out, std::string& err);
@@ -0,0 +1,61 @@
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+
+uint64_t LatencyHistogram::value_at(size_t i) {
+    const size_t sub_count = size_t(1) << SUB_BITS;
+    if (i < sub_count) return uint64_t(i);
+    int shift = int(i >> SUB_BITS) - 1;
+    uint64_t sub = uint64_t(i & (sub_count - 1)) + sub_count;
+    uint64_t lo = sub << shift;
+    return lo + ((uint64_t(1) << shift) >> 1);
+}
+
+uint64_t LatencyHistogram::percentile(double q) const {
+    if (count_ == 0) return 0;
+    if (q <= 0.0) return min_;
+    if (q >= 1.0) return max_;
+    // rank of the sample at quantile q (1-based), matching the nearest-rank definition
+    uint64_t rank = uint64_t(q * double(count_ - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        seen += counts_[i];
+        if (seen >= rank) return std::clamp(value_at(i), min_, max_);
+    }
+    return max_;
+}
+
+void LatencyHistogram::percentiles(const double* q, uint64_t* out, size_t n) const {
+    uint64_t seen = 0;
+    size_t i = 0;
+    for (size_t k = 0; k < n; ++k) {
+        if (count_ == 0 || q[k] <= 0.0 || q[k] >= 1.0) {
+            out[k] = percentile(q[k]);
+            continue;
+        }
+        // ascending quantiles: carry on from the bucket the previous one ended in
+        const uint64_t rank = uint64_t(q[k] * double(count_ - 1)) + 1;
+        while (seen < rank && i < BUCKETS) seen += counts_[i++];
+        out[k] = seen >= rank ? std::clamp(value_at(i - 1), min_, max_) : max_;
+    }
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& o) {
+    for (size_t i = 0; i < BUCKETS; ++i) counts_[i] += o.counts_[i];
+    if (o.count_ != 0) {
+        min_ = std::min(min_, o.min_);
+        max_ = std::max(max_, o.max_);
+    }
+    count_ += o.count_;
+    sum_ += o.sum_;
+    negative_ += o.negative_;
+}
+
+void LatencyHistogram::reset() {
+    counts_.fill(0);
+    count_ = 0;
+    sum_ = 0;
+    min_ = UINT64_MAX;
+    max_ = 0;
+    negative_ = 0;
+}
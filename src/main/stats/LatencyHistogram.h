@@ -0,0 +1,69 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/*
+ Fixed-size log-linear (HDR-style) histogram of non-negative integer values,
+ e.g. latencies in nanoseconds.
+ - values below 2^SUB_BITS are counted exactly; above that, every power of two
+   is split into 2^SUB_BITS linear sub-buckets, so any recorded value is
+   reported within 1/2^SUB_BITS (< 0.8%) of its true value
+ - values at or above 2^MAX_BITS saturate into the top bucket (max() stays exact)
+ - record() is a clz, a shift and an increment: O(1), no allocation, and the
+   whole histogram is a flat array of ~35 KB regardless of run length
+*/
+
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BITS = 7;
+    static constexpr int MAX_BITS = 40;   // ~18 minutes in ns
+    static constexpr size_t BUCKETS = size_t(MAX_BITS - SUB_BITS + 1) << SUB_BITS;
+
+    LatencyHistogram() { reset(); }
+
+    void record(uint64_t v) {
+        ++counts_[index(v)];
+        ++count_;
+        sum_ += v;
+        if (v < min_) min_ = v;
+        if (v > max_) max_ = v;
+    }
+    // signed convenience: negative values (e.g. clock skew between hosts) record as 0 and are counted
+    void record_signed(int64_t v) {
+        if (v < 0) { ++negative_; v = 0; }
+        record(uint64_t(v));
+    }
+
+    // value at quantile q in [0, 1]; 0 if empty
+    uint64_t percentile(double q) const;
+    // percentile() of each of `n` ascending quantiles in one pass over the buckets
+    void percentiles(const double* q, uint64_t* out, size_t n) const;
+    uint64_t count() const { return count_; }
+    uint64_t min() const { return count_ ? min_ : 0; }
+    uint64_t max() const { return max_; }
+    double mean() const { return count_ ? double(sum_) / double(count_) : 0.0; }
+    uint64_t negative() const { return negative_; }
+
+    void merge(const LatencyHistogram& o);
+    void reset();
+
+private:
+    std::array<uint64_t, BUCKETS> counts_;
+    uint64_t count_;
+    uint64_t sum_;
+    uint64_t min_;
+    uint64_t max_;
+    uint64_t negative_;
+
+    static size_t index(uint64_t v) {
+        if (v < (uint64_t(1) << SUB_BITS)) return size_t(v);
+        if (v >= (uint64_t(1) << MAX_BITS)) return BUCKETS - 1;
+        int msb = 63 - __builtin_clzll(v);
+        int shift = msb - SUB_BITS;
+        uint64_t sub = (v >> shift) - (uint64_t(1) << SUB_BITS);
+        return (size_t(shift + 1) << SUB_BITS) + size_t(sub);
+    }
+    // midpoint of the values mapped to bucket i
+    static uint64_t value_at(size_t i);
+};
@@ -0,0 +1,61 @@
+#include "StageProbe.h"
+
+#include <cstdio>
+#include <string>
+
+const char* stage_name(Stage s) {
+    switch (s) {
+    case Stage::Parse: return "parse";
+    case Stage::Ofi: return "ofi";
+    case Stage::Book: return "book";
+    case Stage::Features: return "features";
+    case Stage::Predictor: return "predictor";
+    case Stage::Bank: return "bank";
+    case Stage::Publish: return "publish";
+    case Stage::Engine: return "engine";
+    case Stage::Output: return "output";
+    case Stage::Count: break;
+    }
+    return "unknown";
+}
+
+#if FLOW_IMBALANCE_STAGE_PROBES
+
+void print_stage_stats(std::ostream& os, const char* prefix, const StageStats& s) {
+    static constexpr double Q[] = {0.5, 0.9, 0.99, 0.999};
+    double total = 0.0;
+    for (const LatencyHistogram& h : s.ticks) total += h.mean() * double(h.count());
+    if (total <= 0.0) return;
+    // whole lines go out in one write, so concurrent writers cannot split them
+    std::string out;
+    char buf[160];
+    auto add = [&](int n) {
+        if (n > 0) out.append(buf, size_t(n) < sizeof(buf) ? size_t(n) : sizeof(buf) - 1);
+    };
+    for (size_t i = 0; i < size_t(Stage::Count); ++i) {
+        const LatencyHistogram& h = s.ticks[i];
+        if (h.count() == 0) continue;
+        uint64_t v[4];
+        h.percentiles(Q, v, 4);
+        add(std::snprintf(buf, sizeof(buf), "%s stage name=%s count=%llu", prefix, stage_name(Stage(i)),
+                          (unsigned long long)h.count()));
+        add(std::snprintf(buf, sizeof(buf), " p50=%.1f p90=%.1f p99=%.1f p99.9=%.1f max=%.1f mean=%.1f",
+                          TscClock::to_ns(double(v[0])), TscClock::to_ns(double(v[1])), TscClock::to_ns(double(v[2])),
+                          TscClock::to_ns(double(v[3])), TscClock::to_ns(double(h.max())), TscClock::to_ns(h.mean())));
+        if (TscClock::tsc()) add(std::snprintf(buf, sizeof(buf), " mean_cycles=%.1f", h.mean()));
+        add(std::snprintf(buf, sizeof(buf), " share_pct=%.1f\n", 100.0 * h.mean() * double(h.count()) / total));
+    }
+    add(std::snprintf(buf, sizeof(buf), "%s stages clock=%s ticks_per_us=%.1f clock_read_ns=%.1f total_ms=%.3f", prefix,
+                      TscClock::source(), TscClock::ticks_per_s() / 1e6, TscClock::read_ns(), TscClock::to_ns(total) / 1e6));
+    // engine runs once per processed tick
+    const uint64_t ticks = s.ticks[size_t(Stage::Engine)].count();
+    if (ticks > 0) add(std::snprintf(buf, sizeof(buf), " per_tick_ns=%.1f", TscClock::to_ns(total) / double(ticks)));
+    out += '\n';
+    os.write(out.data(), std::streamsize(out.size()));
+}
+
+#else
+
+void print_stage_stats(std::ostream&, const char*, const StageStats&) {}
+
+#endif
@@ -0,0 +1,85 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+#include "LatencyHistogram.h"
+#include "TscClock.h"
+
+/*
+ Per-stage cost breakdown of the tick path, in TscClock ticks (CPU cycles
+ with the TSC source).
+ - STAGE_PROBE(stats, stage) opens a scoped probe: two clock reads and one
+   histogram record per use. Probes nest; each records its self time (its
+   span minus the probes opened inside it and roughly their clock reads), so
+   the stages of one tick add up to the time spent in probed code and no
+   cycle is counted twice
+ - stages: parse (datagram -> Tick, symbol interning), ofi (compute_ofi and
+   depth snapshots), book (OrderBook::apply_tick), features, predictor,
+   bank, publish (metrics, tick store, interval report), engine (the rest of
+   Engine::process) and output (echo ack and signal log push)
+ - off unless built with -DFLOW_IMBALANCE_STAGE_PROBES=ON: the macro then
+   expands to nothing, its arguments are not evaluated and StageStats is
+   empty, so the default build carries no trace of it
+*/
+
+#ifndef FLOW_IMBALANCE_STAGE_PROBES
+#define FLOW_IMBALANCE_STAGE_PROBES 0
+#endif
+
+enum class Stage : uint8_t { Parse, Ofi, Book, Features, Predictor, Bank, Publish, Engine, Output, Count };
+
+const char* stage_name(Stage s);
+
+struct StageStats {
+#if FLOW_IMBALANCE_STAGE_PROBES
+    LatencyHistogram ticks[size_t(Stage::Count)];
+    void record(Stage s, uint64_t t) { ticks[size_t(s)].record(t); }
+#endif
+};
+
+// one `<prefix> stage name=.. count=.. p50=.. p90=.. p99=.. p99.9=.. max=.. mean=.. share_pct=..`
+// line per stage that ran, in ns (plus mean_cycles with the TSC), and a totals line; nothing
+// when probes are compiled out
+void print_stage_stats(std::ostream& os, const char* prefix, const StageStats& s);
+
+#if FLOW_IMBALANCE_STAGE_PROBES
+
+class StageProbe {
+public:
+    StageProbe(StageStats* stats, Stage stage)
+        : stats_(stats), parent_(current_), stage_(stage), start_(TscClock::now()) {
+        current_ = this;
+    }
+    ~StageProbe() {
+        const uint64_t span = TscClock::now() - start_;
+        current_ = parent_;
+        // the parent also paid for this probe's clock reads; take about one of them off it too
+        if (parent_) parent_->nested_ += span + TscClock::read_ticks();
+        if (stats_) stats_->record(stage_, span > nested_ ? span - nested_ : 0);
+    }
+    StageProbe(const StageProbe&) = delete;
+    StageProbe& operator=(const StageProbe&) = delete;
+
+private:
+    // innermost open probe of this thread
+    inline static thread_local StageProbe* current_ = nullptr;
+
+    StageStats* stats_;
+    StageProbe* parent_;
+    Stage stage_;
+    uint64_t start_;
+    uint64_t nested_ = 0;
+};
+
+#define STAGE_PROBE_CAT_(a, b) a##b
+#define STAGE_PROBE_CAT(a, b) STAGE_PROBE_CAT_(a, b)
+#define STAGE_PROBE(stats, stage) StageProbe STAGE_PROBE_CAT(stage_probe_, __LINE__)((stats), (stage))
+
+#else
+
+#define STAGE_PROBE(stats, stage) \
+    do {                          \
+    } while (0)
+
+#endif
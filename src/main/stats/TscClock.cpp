@@ -0,0 +1,86 @@
+#include "TscClock.h"
+
+#include <algorithm>
+
+#if FLOW_IMBALANCE_HAVE_RDTSC
+#include <cpuid.h>
+#endif
+
+namespace {
+
+uint64_t raw_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return uint64_t(ts.tv_sec) * 1000000000u + uint64_t(ts.tv_nsec);
+}
+
+#if FLOW_IMBALANCE_HAVE_RDTSC
+bool invariant_tsc() {
+    unsigned a, b, c, d;
+    if (!__get_cpuid(0x80000000, &a, &b, &c, &d) || a < 0x80000007) return false;
+    __get_cpuid(0x80000007, &a, &b, &c, &d);
+    return (d >> 8) & 1;
+}
+
+// one (tsc, ns) pair: the clock_gettime read bracketed by the two closest rdtscs of a few tries,
+// so a preemption or interrupt in the middle does not skew the rate
+void sample(uint64_t& tsc, uint64_t& ns) {
+    uint64_t best = UINT64_MAX;
+    for (int i = 0; i < 16; ++i) {
+        const uint64_t t0 = __rdtsc();
+        const uint64_t n = raw_ns();
+        const uint64_t t1 = __rdtsc();
+        if (t1 - t0 < best) {
+            best = t1 - t0;
+            tsc = t0 + (t1 - t0) / 2;
+            ns = n;
+        }
+    }
+}
+#endif
+
+} // namespace
+
+void TscClock::calibrate(double seconds) {
+#if FLOW_IMBALANCE_HAVE_RDTSC
+    if (invariant_tsc()) {
+        uint64_t tsc0 = 0, ns0 = 0, tsc1 = 0, ns1 = 0;
+        sample(tsc0, ns0);
+        const uint64_t until = ns0 + uint64_t(std::max(seconds, 0.001) * 1e9);
+        // spin rather than sleep: the rate is the same, and a short run needs no scheduler wakeup
+        while (raw_ns() < until) {}
+        sample(tsc1, ns1);
+        if (tsc1 > tsc0 && ns1 > ns0) {
+            ns_per_tick_ = double(ns1 - ns0) / double(tsc1 - tsc0);
+            tsc_ = true;
+            measure_read_cost();
+            return;
+        }
+    }
+#else
+    (void)seconds;
+#endif
+    use_clock_gettime();
+}
+
+void TscClock::use_clock_gettime() {
+    tsc_ = false;
+    ns_per_tick_ = 1.0;
+    measure_read_cost();
+}
+
+void TscClock::measure_read_cost() {
+    constexpr int N = 1000;
+    uint64_t best = UINT64_MAX;
+    for (int r = 0; r < 5; ++r) {
+        const uint64_t t0 = now();
+        uint64_t x = 0;
+        for (int i = 0; i < N; ++i) x += now();
+        const uint64_t t1 = now();
+        // keep the reads: the sum feeds an always-false branch the compiler cannot drop
+        if (x == 1) best = 0;
+        best = std::min(best, t1 - t0);
+    }
+    read_ticks_ = best / N;
+    read_ns_ = to_ns(double(best)) / N;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <ctime>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define FLOW_IMBALANCE_HAVE_RDTSC 1
+#else
+#define FLOW_IMBALANCE_HAVE_RDTSC 0
+#endif
+
+/*
+ Interval clock for the tick path.
+ - with an invariant TSC (cpuid 0x80000007 EDX bit 8: constant rate, runs
+   through C-states) now() is one rdtsc, a few ns, instead of a clock_gettime
+   call through the vDSO; calibrate() measures the TSC rate against
+   CLOCK_MONOTONIC_RAW once at startup
+ - anywhere else (no invariant TSC, not x86, calibrate() never called, or
+   use_clock_gettime()) now() is CLOCK_MONOTONIC in ns, so ticks == ns
+ - ticks only mean something as differences on one machine: use to_ns() for
+   durations and deadlines, never as wall time. recv_ts / src_ts stay on the
+   system clock, which NTP keeps comparable across hosts
+ - the source is process wide: pick it before any thread reads the clock
+*/
+
+class TscClock {
+public:
+    // use the TSC if it is invariant, measuring its rate over `seconds`; otherwise clock_gettime
+    static void calibrate(double seconds = 0.02);
+    // switch to clock_gettime regardless of the TSC (e.g. to compare the two)
+    static void use_clock_gettime();
+
+    static uint64_t now() {
+#if FLOW_IMBALANCE_HAVE_RDTSC
+        if (tsc_) return __rdtsc();
+#endif
+        return monotonic_ns();
+    }
+    // tick difference -> ns
+    static int64_t to_ns(int64_t ticks) { return tsc_ ? int64_t(double(ticks) * ns_per_tick_) : ticks; }
+    static double to_ns(double ticks) { return ticks * ns_per_tick_; }
+
+    static bool tsc() { return tsc_; }
+    static const char* source() { return tsc_ ? "tsc" : "clock_gettime"; }
+    // ticks per second: the TSC rate, or 1e9
+    static double ticks_per_s() { return 1e9 / ns_per_tick_; }
+    // cost of one now() call, measured by calibrate()
+    static double read_ns() { return read_ns_; }
+    static uint64_t read_ticks() { return read_ticks_; }
+
+    static uint64_t monotonic_ns() {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return uint64_t(ts.tv_sec) * 1000000000u + uint64_t(ts.tv_nsec);
+    }
+
+private:
+    inline static bool tsc_ = false;
+    inline static double ns_per_tick_ = 1.0;
+    inline static double read_ns_ = 0.0;
+    inline static uint64_t read_ticks_ = 0;
+
+    static void measure_read_cost();
+};
@@ -0,0 +1,225 @@
+#include "ColumnStore.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+std::string errno_text(const char* what, const std::string& path) {
+    return std::string(what) + "(" + path + "): " + std::strerror(errno);
+}
+
+bool ends_with(const std::string& s, const char* suffix) {
+    const size_t n = std::strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+// names of the entries of `dir` accepted by `keep`, sorted
+template <typename Keep>
+std::vector<std::string> list_dir(const std::string& dir, Keep&& keep) {
+    std::vector<std::string> out;
+    DIR* d = opendir(dir.c_str());
+    if (!d) return out;
+    while (dirent* e = readdir(d)) {
+        std::string n(e->d_name);
+        if (keep(n)) out.push_back(std::move(n));
+    }
+    closedir(d);
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+bool is_segment_name(const std::string& n) { return n.size() == 10 && n.compare(0, 4, "seg-") == 0; }
+
+} // namespace
+
+const char* column_encoding_name(ColumnEncoding e) {
+    switch (e) {
+    case ColumnEncoding::F64: return "f64";
+    case ColumnEncoding::U32: return "u32";
+    case ColumnEncoding::I8: return "i8";
+    case ColumnEncoding::Delta: return "delta";
+    case ColumnEncoding::DeltaTs: return "delta_ts";
+    }
+    return "unknown";
+}
+
+uint32_t column_width(ColumnEncoding e) {
+    switch (e) {
+    case ColumnEncoding::F64: return 8;
+    case ColumnEncoding::U32: return 4;
+    case ColumnEncoding::I8: return 1;
+    default: return 0;
+    }
+}
+
+std::string segment_dir(const std::string& dir, uint32_t index) {
+    char name[16];
+    std::snprintf(name, sizeof(name), "seg-%06u", index);
+    std::string s;
+    s.reserve(dir.size() + 1 + sizeof(name));
+    s += dir;
+    s += '/';
+    s += name;
+    return s;
+}
+
+uint32_t next_segment_index(const std::string& dir) {
+    const std::vector<std::string> segs = list_dir(dir, is_segment_name);
+    if (segs.empty()) return 0;
+    return uint32_t(std::strtoul(segs.back().c_str() + 4, nullptr, 10)) + 1;
+}
+
+bool ColumnWriter::open(const std::string& path, const std::string& name, ColumnEncoding enc, std::string& err) {
+    close();
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        err = errno_text("open", path);
+        return false;
+    }
+    const size_t size = COLUMN_CHUNK;
+    if (int rc = posix_fallocate(fd, 0, off_t(size)); rc != 0) {
+        errno = rc;
+        err = errno_text("posix_fallocate", path);
+        ::close(fd);
+        return false;
+    }
+    void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        err = errno_text("mmap", path);
+        ::close(fd);
+        return false;
+    }
+    fd_ = fd;
+    base_ = static_cast<char*>(p);
+    mapped_ = size;
+    used_ = 0;
+    rows_ = 0;
+    prev_ = 0;
+    path_ = path;
+
+    ColumnHeader* h = reinterpret_cast<ColumnHeader*>(base_);
+    std::memcpy(h->magic, "FICS", 4);
+    h->version = COLUMN_VERSION;
+    h->encoding = uint32_t(enc);
+    h->width = column_width(enc);
+    std::snprintf(h->name, sizeof(h->name), "%s", name.c_str());
+    return true;
+}
+
+bool ColumnWriter::grow(size_t n) {
+    size_t size = mapped_ + COLUMN_CHUNK;
+    while (sizeof(ColumnHeader) + used_ + n > size) size += COLUMN_CHUNK;
+    // out of disk or address space: the mapping stays as it is, and close() cuts the file
+    // back to what was written
+    if (int rc = posix_fallocate(fd_, off_t(mapped_), off_t(size - mapped_)); rc != 0) {
+        errno = rc;
+        std::perror(("ColumnWriter: grow " + path_).c_str());
+        return false;
+    }
+    void* p = mremap(base_, mapped_, size, MREMAP_MAYMOVE);
+    if (p == MAP_FAILED) {
+        std::perror(("ColumnWriter: grow " + path_).c_str());
+        return false;
+    }
+    base_ = static_cast<char*>(p);
+    mapped_ = size;
+    return true;
+}
+
+void ColumnWriter::publish() {
+    ColumnHeader* h = reinterpret_cast<ColumnHeader*>(base_);
+    std::atomic_ref<uint64_t>(h->rows).store(rows_, std::memory_order_relaxed);
+    std::atomic_ref<uint64_t>(h->bytes).store(used_, std::memory_order_release);
+}
+
+void ColumnWriter::close() {
+    if (!base_) return;
+    publish();
+    munmap(base_, mapped_);
+    if (ftruncate(fd_, off_t(sizeof(ColumnHeader) + used_)) < 0) std::perror(("ColumnWriter: ftruncate " + path_).c_str());
+    ::close(fd_);
+    base_ = nullptr;
+    fd_ = -1;
+    mapped_ = 0;
+}
+
+ColumnFile::~ColumnFile() {
+    if (base_) munmap(const_cast<char*>(base_), size_);
+}
+
+bool ColumnFile::open(const std::string& path, std::string& err) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        err = errno_text("open", path);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || size_t(st.st_size) < sizeof(ColumnHeader)) {
+        err = path + ": not a column file (too small)";
+        ::close(fd);
+        return false;
+    }
+    void* p = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        err = errno_text("mmap", path);
+        return false;
+    }
+    const ColumnHeader* h = static_cast<const ColumnHeader*>(p);
+    if (std::memcmp(h->magic, "FICS", 4) != 0 || h->version != COLUMN_VERSION || h->encoding > uint32_t(ColumnEncoding::DeltaTs)) {
+        err = path + ": not a column file, or an unsupported version";
+        munmap(p, size_t(st.st_size));
+        return false;
+    }
+    // sequential scans: let the kernel read ahead aggressively
+    madvise(p, size_t(st.st_size), MADV_SEQUENTIAL);
+    if (base_) munmap(const_cast<char*>(base_), size_);
+    base_ = static_cast<const char*>(p);
+    size_ = size_t(st.st_size);
+    return true;
+}
+
+std::string ColumnFile::name() const {
+    const ColumnHeader& h = header();
+    return std::string(h.name, strnlen(h.name, sizeof(h.name)));
+}
+
+uint64_t ColumnFile::bytes() const {
+    // the writer publishes `bytes` after the payload it covers; never trust it past the mapping
+    const uint64_t b = std::atomic_ref<uint64_t>(const_cast<uint64_t&>(header().bytes)).load(std::memory_order_acquire);
+    return std::min<uint64_t>(b, size_ - sizeof(ColumnHeader));
+}
+
+bool StoreReader::open(const std::string& dir, std::string& err) {
+    dir_ = dir;
+    segments_.clear();
+    columns_.clear();
+    for (const std::string& s : list_dir(dir, is_segment_name)) segments_.push_back(dir + "/" + s);
+    if (segments_.empty()) {
+        err = dir + ": no segments (seg-NNNNNN) found";
+        return false;
+    }
+    for (std::string& c : list_dir(segments_.front(), [](const std::string& n) { return ends_with(n, ".col"); })) {
+        c.resize(c.size() - 4);
+        columns_.push_back(std::move(c));
+    }
+    return true;
+}
+
+bool StoreReader::has_column(const std::string& name) const {
+    return std::find(columns_.begin(), columns_.end(), name) != columns_.end();
+}
+
+std::string StoreReader::column_path(size_t segment, const std::string& column) const {
+    return segments_[segment] + "/" + column + ".col";
+}
@@ -0,0 +1,268 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/*
+ Columnar, memory-mapped tick store: the on-disk format plus the writer and
+ reader used by store/TickStore.h and flow_imbalance_colscan.
+ - a store is a directory of segments `seg-000000`, `seg-000001`, ...; a
+   segment is a directory holding one file per column, `<name>.col`
+ - a column file is a ColumnHeader followed by the encoded values. Values are
+   fixed-width little-endian (f64 / u32 / i8), or zigzag LEB128 varints of the
+   difference to the previous value (seq, and timestamps as integer ns)
+ - delta chains restart at 0 in every segment, so each segment and each
+   column decodes on its own: scanning one column never touches the others
+ - ColumnWriter maps the file MAP_SHARED and grows it in COLUMN_CHUNK steps
+   (posix_fallocate + mremap), so the mapping only spans what has been
+   written; the file is cut back to header + payload on close. The blocks are
+   allocated before they are mapped, so a full disk fails the grow (the put
+   returns false) instead of faulting a store through the mapping
+ - the header's `bytes` is stored with release semantics after the payload,
+   so a reader of a segment still being written sees a valid prefix
+*/
+
+struct ColumnHeader {
+    char magic[4];       // "FICS"
+    uint32_t version;    // 1
+    uint32_t encoding;   // ColumnEncoding
+    uint32_t width;      // bytes per value for fixed-width encodings, 0 for varints
+    uint64_t rows;       // values written
+    uint64_t bytes;      // payload bytes after the header
+    char name[32];       // NUL padded
+};
+
+static_assert(sizeof(ColumnHeader) == 64, "ColumnHeader is a file format");
+
+constexpr uint32_t COLUMN_VERSION = 1;
+// mapping growth step per column
+constexpr size_t COLUMN_CHUNK = size_t(1) << 20;
+
+enum class ColumnEncoding : uint32_t {
+    F64 = 0,
+    U32 = 1,
+    I8 = 2,
+    Delta = 3,     // int64, zigzag varint of the delta to the previous value
+    DeltaTs = 4,   // seconds as a double, stored as Delta of integer nanoseconds
+};
+
+const char* column_encoding_name(ColumnEncoding e);
+// bytes per value, 0 for varint encodings
+uint32_t column_width(ColumnEncoding e);
+
+// epoch seconds <-> integer ns. Splitting off the whole seconds first keeps the
+// fraction exact, so ns_to_ts(ts_to_ns(t)) == t for any epoch-scale double
+inline int64_t ts_to_ns(double ts) {
+    if (!std::isfinite(ts)) return 0;
+    const double s = std::floor(ts);
+    return int64_t(s) * 1000000000 + std::llround((ts - s) * 1e9);
+}
+inline double ns_to_ts(int64_t ns) {
+    int64_t s = ns / 1000000000;
+    int64_t frac = ns % 1000000000;
+    if (frac < 0) {
+        --s;
+        frac += 1000000000;
+    }
+    return double(s) + double(frac) / 1e9;
+}
+
+inline uint64_t zigzag(int64_t v) { return (uint64_t(v) << 1) ^ uint64_t(v >> 63); }
+inline int64_t unzigzag(uint64_t v) { return int64_t(v >> 1) ^ -int64_t(v & 1); }
+
+class ColumnWriter {
+public:
+    // longest encoding of one value (a 64-bit varint)
+    static constexpr size_t MAX_VALUE_BYTES = 10;
+
+    ColumnWriter() = default;
+    ~ColumnWriter() { close(); }
+    ColumnWriter(const ColumnWriter&) = delete;
+    ColumnWriter& operator=(const ColumnWriter&) = delete;
+
+    // create/truncate `path`; false with `err` set on failure
+    bool open(const std::string& path, const std::string& name, ColumnEncoding enc, std::string& err);
+    bool is_open() const { return base_ != nullptr; }
+
+    // room for `n` more payload bytes; false, with nothing changed, if the file cannot grow
+    bool reserve(size_t n) { return sizeof(ColumnHeader) + used_ + n <= mapped_ || grow(n); }
+
+    // append one value; false, with nothing written, if the file cannot grow
+    bool put_f64(double v) { return put_raw(&v, sizeof(v)); }
+    bool put_u32(uint32_t v) { return put_raw(&v, sizeof(v)); }
+    bool put_i8(int8_t v) { return put_raw(&v, sizeof(v)); }
+    bool put_delta(int64_t v) {
+        if (!reserve(MAX_VALUE_BYTES)) return false;
+        uint64_t z = zigzag(int64_t(uint64_t(v) - uint64_t(prev_)));
+        prev_ = v;
+        char* p = base_ + sizeof(ColumnHeader) + used_;
+        char* const start = p;
+        while (z >= 0x80) {
+            *p++ = char(z | 0x80);
+            z >>= 7;
+        }
+        *p++ = char(z);
+        used_ += size_t(p - start);
+        ++rows_;
+        return true;
+    }
+    bool put_ts(double ts) { return put_delta(ts_to_ns(ts)); }
+
+    // make rows/bytes written so far visible to readers
+    void publish();
+    // publish, cut the file to its used size and unmap; safe to call twice
+    void close();
+
+    uint64_t rows() const { return rows_; }
+    // payload bytes, without the header
+    uint64_t bytes() const { return used_; }
+
+private:
+    int fd_ = -1;
+    char* base_ = nullptr;
+    size_t mapped_ = 0;
+    size_t used_ = 0;
+    uint64_t rows_ = 0;
+    int64_t prev_ = 0;
+    std::string path_;
+
+    bool grow(size_t n);
+    bool put_raw(const void* v, size_t n) {
+        if (!reserve(n)) return false;
+        std::memcpy(base_ + sizeof(ColumnHeader) + used_, v, n);
+        used_ += n;
+        ++rows_;
+        return true;
+    }
+};
+
+// one column file, mapped read-only
+class ColumnFile {
+public:
+    ColumnFile() = default;
+    ~ColumnFile();
+    ColumnFile(const ColumnFile&) = delete;
+    ColumnFile& operator=(const ColumnFile&) = delete;
+
+    bool open(const std::string& path, std::string& err);
+
+    std::string name() const;
+    ColumnEncoding encoding() const { return ColumnEncoding(header().encoding); }
+    uint64_t rows() const { return header().rows; }
+    // payload bytes valid right now (grows while the writer is live)
+    uint64_t bytes() const;
+    // file size, header included
+    size_t file_size() const { return size_; }
+    // integer encodings (U32, I8, Delta; DeltaTs as ns) decode exactly
+    bool integral() const { return encoding() != ColumnEncoding::F64; }
+
+    // f(double) for every value in order; timestamps in seconds. Returns the values visited
+    template <typename F>
+    uint64_t scan(F&& f) const;
+    // f(int64_t) for every value of an integral column (timestamps in ns); 0 for F64
+    template <typename F>
+    uint64_t scan_int(F&& f) const;
+
+private:
+    const char* base_ = nullptr;
+    size_t size_ = 0;
+
+    const ColumnHeader& header() const { return *reinterpret_cast<const ColumnHeader*>(base_); }
+    const char* payload() const { return base_ + sizeof(ColumnHeader); }
+    // walks the varints of a Delta / DeltaTs column; stops at a value cut short
+    template <typename F>
+    uint64_t scan_delta(F&& f) const;
+};
+
+// the segments and column names of a store directory
+class StoreReader {
+public:
+    bool open(const std::string& dir, std::string& err);
+
+    const std::string& dir() const { return dir_; }
+    // segment directories in write order
+    const std::vector<std::string>& segments() const { return segments_; }
+    // column names present in the first segment, sorted
+    const std::vector<std::string>& columns() const { return columns_; }
+    bool has_column(const std::string& name) const;
+    std::string column_path(size_t segment, const std::string& column) const;
+
+private:
+    std::string dir_;
+    std::vector<std::string> segments_;
+    std::vector<std::string> columns_;
+};
+
+// `seg-NNNNNN` under `dir`, and the index of the first unused one (0 for a new store)
+std::string segment_dir(const std::string& dir, uint32_t index);
+uint32_t next_segment_index(const std::string& dir);
+
+template <typename F>
+uint64_t ColumnFile::scan_delta(F&& f) const {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(payload());
+    const unsigned char* const end = p + bytes();
+    int64_t v = 0;
+    uint64_t n = 0;
+    while (p < end) {
+        uint64_t z = 0;
+        int shift = 0;
+        for (;;) {
+            if (p == end || shift > 63) return n;
+            const unsigned char b = *p++;
+            z |= uint64_t(b & 0x7f) << shift;
+            if (!(b & 0x80)) break;
+            shift += 7;
+        }
+        v = int64_t(uint64_t(v) + uint64_t(unzigzag(z)));
+        f(v);
+        ++n;
+    }
+    return n;
+}
+
+template <typename F>
+uint64_t ColumnFile::scan_int(F&& f) const {
+    const char* p = payload();
+    const uint64_t len = bytes();
+    switch (encoding()) {
+    case ColumnEncoding::U32:
+        for (uint64_t i = 0; i + 4 <= len; i += 4) {
+            uint32_t v;
+            std::memcpy(&v, p + i, 4);
+            f(int64_t(v));
+        }
+        return len / 4;
+    case ColumnEncoding::I8:
+        for (uint64_t i = 0; i < len; ++i) f(int64_t(int8_t(p[i])));
+        return len;
+    case ColumnEncoding::Delta:
+    case ColumnEncoding::DeltaTs:
+        return scan_delta([&](int64_t v) { f(v); });
+    case ColumnEncoding::F64:
+        break;
+    }
+    return 0;
+}
+
+template <typename F>
+uint64_t ColumnFile::scan(F&& f) const {
+    switch (encoding()) {
+    case ColumnEncoding::F64: {
+        const char* p = payload();
+        const uint64_t len = bytes();
+        for (uint64_t i = 0; i + 8 <= len; i += 8) {
+            double v;
+            std::memcpy(&v, p + i, 8);
+            f(v);
+        }
+        return len / 8;
+    }
+    case ColumnEncoding::DeltaTs:
+        return scan_delta([&](int64_t v) { f(ns_to_ts(v)); });
+    default:
+        return scan_int([&](int64_t v) { f(double(v)); });
+    }
+}
@@ -0,0 +1,173 @@
+#include "TickStore.h"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+struct ColumnSpec {
+    const char* name;
+    ColumnEncoding encoding;
+};
+
+// indexed by TickStore::Column
+constexpr ColumnSpec COLUMNS[] = {
+    {"seq", ColumnEncoding::Delta},     {"src_ts", ColumnEncoding::DeltaTs}, {"recv_ts", ColumnEncoding::DeltaTs},
+    {"price", ColumnEncoding::F64},     {"size", ColumnEncoding::U32},       {"symbol", ColumnEncoding::U32},
+    {"ofi", ColumnEncoding::F64},       {"ewma", ColumnEncoding::F64},       {"action", ColumnEncoding::I8},
+    {"bank_vote", ColumnEncoding::Delta},
+};
+
+// widest row: four varints plus the fixed-width columns
+constexpr size_t MAX_ROW_BYTES = 4 * ColumnWriter::MAX_VALUE_BYTES + 3 * 8 + 2 * 4 + 1;
+
+} // namespace
+
+TickStore::TickStore(const TickStoreConfig& cfg, const SymbolTable& symbols)
+    : cfg_(cfg), ring_(cfg.ring), symbols_(symbols) {
+    static_assert(sizeof(COLUMNS) / sizeof(COLUMNS[0]) == NCOLUMNS, "one spec per column");
+    if (cfg_.segment_bytes < MAX_ROW_BYTES) cfg_.segment_bytes = MAX_ROW_BYTES;
+}
+
+TickStore::~TickStore() { stop(); }
+
+bool TickStore::open(std::string& err) {
+    if (mkdir(cfg_.dir.c_str(), 0755) < 0 && errno != EEXIST) {
+        err = "mkdir(" + cfg_.dir + "): " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (stat(cfg_.dir.c_str(), &st) < 0 || !S_ISDIR(st.st_mode)) {
+        err = cfg_.dir + ": not a directory";
+        return false;
+    }
+    next_segment_ = next_segment_index(cfg_.dir);
+    return true;
+}
+
+void TickStore::start() {
+    if (writer_.joinable()) return;
+    stopping_.store(false, std::memory_order_relaxed);
+    writer_ = std::thread([this] { run(); });
+}
+
+bool TickStore::open_segment() {
+    const auto now = std::chrono::steady_clock::now();
+    if (failing_ && now < retry_at_) return false;
+    const std::string dir = segment_dir(cfg_.dir, next_segment_);
+    std::string err;
+    if (mkdir(dir.c_str(), 0755) < 0 && errno != EEXIST) err = "mkdir(" + dir + "): " + std::strerror(errno);
+    int c = 0;
+    for (; c < NCOLUMNS && err.empty(); ++c) {
+        cols_[c].open(dir + "/" + COLUMNS[c].name + ".col", COLUMNS[c].name, COLUMNS[c].encoding, err);
+    }
+    if (!err.empty()) {
+        // remove the partial segment so readers never see it; only the first error of a run
+        // of failures is printed
+        if (!failing_) std::cerr << "TickStore: " << err << "\n";
+        failing_ = true;
+        retry_at_ = now + std::chrono::seconds(1);
+        for (int k = 0; k < c; ++k) {
+            cols_[k].close();
+            unlink((dir + "/" + COLUMNS[k].name + ".col").c_str());
+        }
+        rmdir(dir.c_str());
+        return false;
+    }
+    failing_ = false;
+    ++next_segment_;
+    ++segments_;
+    return true;
+}
+
+uint64_t TickStore::segment_bytes() const {
+    uint64_t b = 0;
+    for (const ColumnWriter& w : cols_) b += w.bytes();
+    return b;
+}
+
+void TickStore::close_segment() {
+    closed_bytes_ += segment_bytes();
+    for (ColumnWriter& w : cols_) w.close();
+}
+
+void TickStore::append(const StoreTick& t) {
+    // a segment that cannot be created or grown loses its rows rather than the process
+    if (!cols_[SEQ].is_open() && !open_segment()) {
+        lost_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    // room in every column before the first put, so a failed grow never leaves a partial row
+    for (ColumnWriter& w : cols_) {
+        if (!w.reserve(ColumnWriter::MAX_VALUE_BYTES)) {
+            close_segment();
+            lost_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    cols_[SEQ].put_delta(int64_t(t.seq));
+    cols_[SRC_TS].put_ts(t.src_ts);
+    cols_[RECV_TS].put_ts(t.recv_ts);
+    cols_[PRICE].put_f64(t.price);
+    cols_[SIZE].put_u32(t.size);
+    cols_[SYMBOL].put_u32(t.symbol);
+    cols_[OFI].put_f64(t.ofi);
+    cols_[EWMA].put_f64(t.ewma);
+    cols_[ACTION].put_i8(t.action);
+    cols_[BANK_VOTE].put_delta(t.bank_vote);
+    rows_.fetch_add(1, std::memory_order_relaxed);
+    // roll before the segment could exceed its budget with the next row
+    if (segment_bytes() + MAX_ROW_BYTES > cfg_.segment_bytes) close_segment();
+}
+
+void TickStore::publish() {
+    if (!cols_[SEQ].is_open()) {
+        bytes_.store(closed_bytes_, std::memory_order_relaxed);
+        return;
+    }
+    for (ColumnWriter& w : cols_) w.publish();
+    bytes_.store(closed_bytes_ + segment_bytes(), std::memory_order_relaxed);
+}
+
+void TickStore::run() {
+    StoreTick t;
+    for (;;) {
+        bool any = false;
+        while (ring_.try_pop(t)) {
+            append(t);
+            any = true;
+        }
+        if (any) publish();
+        else {
+            // the producer stores everything before setting stopping_, so one more drain is enough
+            if (stopping_.load(std::memory_order_acquire)) {
+                while (ring_.try_pop(t)) append(t);
+                publish();
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+}
+
+void TickStore::stop() {
+    if (writer_.joinable()) {
+        stopping_.store(true, std::memory_order_release);
+        writer_.join();
+    }
+    if (cols_[SEQ].is_open()) close_segment();
+    bytes_.store(closed_bytes_, std::memory_order_relaxed);
+    // ids are only stable within one run, so each segment this run wrote gets the names
+    for (uint32_t seg = next_segment_ - segments_; seg < next_segment_; ++seg) {
+        FILE* f = std::fopen((segment_dir(cfg_.dir, seg) + "/symbols").c_str(), "w");
+        if (!f) continue;
+        for (uint32_t id = 0; id < symbols_.size(); ++id) std::fprintf(f, "%u %s\n", id, symbols_.name(id).c_str());
+        std::fclose(f);
+    }
+}
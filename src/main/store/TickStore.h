@@ -0,0 +1,108 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "../SymbolTable.h"
+#include "../pipeline/SpscRing.h"
+#include "ColumnStore.h"
+
+/*
+ Per-tick columnar sink (--store=<dir>): every processed tick, HOLD included,
+ with its OFI, EWMA and action, for offline analysis without a rerun.
+ - same split as the signal log: the hot thread copies one 64-byte StoreTick
+   into an SPSC ring; a background thread appends it to the column writers,
+   so page faults, file growth and segment rolls never stall the tick path
+ - columns (ColumnStore.h): seq, src_ts, recv_ts, bank_vote (delta varints),
+   price, ofi, ewma (f64), size, symbol (u32), action (i8). bank_vote is the
+   --bank ensemble vote, 0 without a bank
+ - a segment is closed once its columns hold `segment_bytes` of payload and
+   the next tick opens a new one; a store reopened later continues after its
+   last segment. Symbol ids are per run, so stop() writes the names into each
+   segment of this run as `symbols` ("<id> <name>" per line)
+ - the store is optional analytics: a segment that cannot be created or grown
+   (e.g. out of disk) is closed at its last complete row, and the rows the
+   writer could not keep are counted in lost() and dropped. A segment that
+   fails to open is removed again, and opening is retried at most once a second
+*/
+
+struct StoreTick {
+    uint64_t seq;
+    double src_ts;
+    double recv_ts;
+    double price;
+    double ofi;
+    double ewma;
+    uint32_t size;
+    uint32_t symbol;
+    int8_t action;   // 1=BUY, -1=SELL, 0=HOLD
+    int32_t bank_vote;
+};
+
+struct TickStoreConfig {
+    std::string dir;
+    // payload bytes per segment, summed over its columns
+    size_t segment_bytes = size_t(64) << 20;
+    size_t ring = 65536;
+};
+
+class TickStore {
+public:
+    // names are read from `symbols` on stop(), after the producer is done
+    TickStore(const TickStoreConfig& cfg, const SymbolTable& symbols);
+    ~TickStore();
+
+    // create the directory (an existing store is appended to); false with `err` set on failure
+    bool open(std::string& err);
+    void start();
+    // hot path: enqueue one tick, false (and counted) if the ring is full. single producer only
+    bool record(const StoreTick& t) { return ring_.try_push(t); }
+    // same, but waits for the writer when the ring is full (offline replay)
+    void record_wait(const StoreTick& t) { ring_.push(t); }
+    // drain, join the writer, close the open segment and write the symbols files
+    void stop();
+
+    // writer side: append one row, rolling the segment when it is full. Called by
+    // the writer thread; public so the benchmark can time it without the ring
+    void append(const StoreTick& t);
+
+    const std::string& dir() const { return cfg_.dir; }
+    uint64_t rows() const { return rows_.load(std::memory_order_relaxed); }
+    // payload bytes over every closed segment plus the open one
+    uint64_t bytes() const { return bytes_.load(std::memory_order_relaxed); }
+    // segments opened by this run
+    uint32_t segments() const { return segments_; }
+    uint64_t drops() const { return ring_.drops(); }
+    // rows that reached the writer but could not be stored (segment open or growth failed)
+    uint64_t lost() const { return lost_.load(std::memory_order_relaxed); }
+    uint64_t high_water() const { return ring_.high_water(); }
+    size_t depth() const { return ring_.size(); }
+    size_t capacity() const { return ring_.capacity(); }
+
+private:
+    enum Column { SEQ, SRC_TS, RECV_TS, PRICE, SIZE, SYMBOL, OFI, EWMA, ACTION, BANK_VOTE, NCOLUMNS };
+
+    TickStoreConfig cfg_;
+    SpscRing<StoreTick> ring_;
+    const SymbolTable& symbols_;
+    ColumnWriter cols_[NCOLUMNS];
+    uint32_t next_segment_ = 0;
+    uint32_t segments_ = 0;
+    uint64_t closed_bytes_ = 0;   // payload of segments already closed
+    bool failing_ = false;        // last segment open failed; report the next failure only once it recovers
+    std::chrono::steady_clock::time_point retry_at_{};   // no segment open before this while failing_
+    std::thread writer_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<uint64_t> rows_{0};
+    std::atomic<uint64_t> bytes_{0};
+    std::atomic<uint64_t> lost_{0};
+
+    bool open_segment();
+    void close_segment();
+    uint64_t segment_bytes() const;
+    void publish();
+    void run();
+};
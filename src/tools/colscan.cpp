@@ -0,0 +1,206 @@
+// flow_imbalance_colscan -- list or scan a columnar tick store written with --store=<dir>
+// Usage: flow_imbalance_colscan <dir> [--column=<name>[,<name>...]] [--stats] [--csv] [--limit=<n>]
+//   (no --column)  one SEGMENT line per segment and one COLUMN line per column: encoding,
+//                  rows, bytes and bytes per row
+//   --column=<c>   print the values of the named columns, one row per line, space separated
+//                  (timestamps in seconds, symbol as its name when the segment has one)
+//   --csv          comma separated, with a header line
+//   --stats        per column count/min/max/mean instead of the values, plus the scan rate
+//   --limit=<n>    stop after n rows
+//
+// Only the named columns are mapped and decoded; the other files of a segment are never read.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "main/store/ColumnStore.h"
+
+namespace {
+
+// "<id> <name>" lines of a segment's symbols file; empty if it has none
+std::vector<std::string> load_symbols(const std::string& segment) {
+    std::vector<std::string> names;
+    std::ifstream in(segment + "/symbols");
+    uint32_t id;
+    std::string name;
+    while (in >> id >> name) {
+        if (id >= names.size()) names.resize(id + 1);
+        names[id] = name;
+    }
+    return names;
+}
+
+int list(const StoreReader& store) {
+    struct Total { ColumnEncoding enc = ColumnEncoding::F64; uint64_t rows = 0, bytes = 0; };
+    std::vector<Total> totals(store.columns().size());
+    uint64_t rows = 0;
+    for (size_t s = 0; s < store.segments().size(); ++s) {
+        uint64_t seg_rows = 0, seg_bytes = 0;
+        for (size_t c = 0; c < store.columns().size(); ++c) {
+            ColumnFile col;
+            std::string err;
+            if (!col.open(store.column_path(s, store.columns()[c]), err)) {
+                std::fprintf(stderr, "%s\n", err.c_str());
+                continue;
+            }
+            totals[c].enc = col.encoding();
+            totals[c].rows += col.rows();
+            totals[c].bytes += col.bytes();
+            if (col.rows() > seg_rows) seg_rows = col.rows();
+            seg_bytes += col.bytes();
+        }
+        std::printf("SEGMENT path=%s rows=%llu bytes=%llu\n", store.segments()[s].c_str(), (unsigned long long)seg_rows,
+                    (unsigned long long)seg_bytes);
+        rows += seg_rows;
+    }
+    for (size_t c = 0; c < store.columns().size(); ++c) {
+        const Total& t = totals[c];
+        std::printf("COLUMN name=%s encoding=%s rows=%llu bytes=%llu bytes_per_row=%.2f\n", store.columns()[c].c_str(),
+                    column_encoding_name(t.enc), (unsigned long long)t.rows, (unsigned long long)t.bytes,
+                    t.rows ? double(t.bytes) / double(t.rows) : 0.0);
+    }
+    std::printf("STORE dir=%s segments=%zu rows=%llu\n", store.dir().c_str(), store.segments().size(),
+                (unsigned long long)rows);
+    return 0;
+}
+
+// one column over every segment, nothing but that column's files touched
+int stats(const StoreReader& store, const std::vector<std::string>& names, uint64_t limit) {
+    for (const std::string& name : names) {
+        uint64_t n = 0;
+        double sum = 0.0;
+        double lo = std::numeric_limits<double>::infinity(), hi = -lo;
+        uint64_t bytes = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t s = 0; s < store.segments().size() && n < limit; ++s) {
+            ColumnFile col;
+            std::string err;
+            if (!col.open(store.column_path(s, name), err)) {
+                std::fprintf(stderr, "%s\n", err.c_str());
+                return 1;
+            }
+            bytes += col.bytes();
+            col.scan([&](double v) {
+                if (n >= limit) return;
+                ++n;
+                sum += v;
+                if (v < lo) lo = v;
+                if (v > hi) hi = v;
+            });
+        }
+        const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::printf("COLUMN name=%s count=%llu min=%.17g max=%.17g mean=%.17g bytes=%llu scan_ms=%.3f", name.c_str(),
+                    (unsigned long long)n, n ? lo : 0.0, n ? hi : 0.0, n ? sum / double(n) : 0.0,
+                    (unsigned long long)bytes, secs * 1e3);
+        if (secs > 0.0) std::printf(" values_per_s=%.0f", double(n) / secs);
+        std::printf("\n");
+    }
+    return 0;
+}
+
+// the named columns side by side, decoded one segment at a time
+int dump(const StoreReader& store, const std::vector<std::string>& names, bool csv, uint64_t limit) {
+    const char sep = csv ? ',' : ' ';
+    if (csv) {
+        for (size_t c = 0; c < names.size(); ++c) std::printf("%s%s", c ? "," : "", names[c].c_str());
+        std::printf("\n");
+    }
+    uint64_t printed = 0;
+    for (size_t s = 0; s < store.segments().size() && printed < limit; ++s) {
+        std::vector<std::unique_ptr<ColumnFile>> cols;
+        std::vector<std::vector<double>> vals(names.size());
+        std::vector<std::vector<int64_t>> ints(names.size());
+        size_t rows = std::numeric_limits<size_t>::max();
+        for (size_t c = 0; c < names.size(); ++c) {
+            cols.emplace_back(new ColumnFile());
+            std::string err;
+            if (!cols[c]->open(store.column_path(s, names[c]), err)) {
+                std::fprintf(stderr, "%s\n", err.c_str());
+                return 1;
+            }
+            // integers (timestamps aside) print exactly, not through a double
+            if (cols[c]->integral() && cols[c]->encoding() != ColumnEncoding::DeltaTs) {
+                cols[c]->scan_int([&](int64_t v) { ints[c].push_back(v); });
+                if (ints[c].size() < rows) rows = ints[c].size();
+            } else {
+                cols[c]->scan([&](double v) { vals[c].push_back(v); });
+                if (vals[c].size() < rows) rows = vals[c].size();
+            }
+        }
+        const std::vector<std::string> symbols = load_symbols(store.segments()[s]);
+        for (size_t r = 0; r < rows && printed < limit; ++r, ++printed) {
+            for (size_t c = 0; c < names.size(); ++c) {
+                if (c) std::putchar(sep);
+                const ColumnEncoding enc = cols[c]->encoding();
+                if (enc == ColumnEncoding::DeltaTs) {
+                    std::printf("%.9f", vals[c][r]);
+                } else if (enc == ColumnEncoding::F64) {
+                    std::printf("%.17g", vals[c][r]);
+                } else if (names[c] == "symbol" && size_t(ints[c][r]) < symbols.size()) {
+                    std::printf("%s", symbols[size_t(ints[c][r])].c_str());
+                } else {
+                    std::printf("%lld", (long long)ints[c][r]);
+                }
+            }
+            std::putchar('\n');
+        }
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string dir;
+    std::vector<std::string> columns;
+    bool csv = false, want_stats = false;
+    uint64_t limit = std::numeric_limits<uint64_t>::max();
+    for (int i = 1; i < argc; ++i) {
+        std::string a(argv[i]);
+        if (a.rfind("--column=", 0) == 0) {
+            std::stringstream ss(a.substr(9));
+            std::string item;
+            while (std::getline(ss, item, ',')) {
+                if (!item.empty()) columns.push_back(item);
+            }
+        } else if (a == "--csv") {
+            csv = true;
+        } else if (a == "--stats") {
+            want_stats = true;
+        } else if (a.rfind("--limit=", 0) == 0) {
+            limit = std::strtoull(a.c_str() + 8, nullptr, 10);
+        } else if (!a.empty() && a[0] != '-' && dir.empty()) {
+            dir = a;
+        } else {
+            dir.clear();
+            break;
+        }
+    }
+    if (dir.empty()) {
+        std::fprintf(stderr, "usage: %s <dir> [--column=<name>[,<name>...]] [--stats] [--csv] [--limit=<n>]\n", argv[0]);
+        return 2;
+    }
+    StoreReader store;
+    std::string err;
+    if (!store.open(dir, err)) {
+        std::fprintf(stderr, "%s\n", err.c_str());
+        return 1;
+    }
+    if (columns.empty()) return list(store);
+    for (const std::string& c : columns) {
+        if (!store.has_column(c)) {
+            std::fprintf(stderr, "unknown column %s; the store has:", c.c_str());
+            for (const std::string& n : store.columns()) std::fprintf(stderr, " %s", n.c_str());
+            std::fprintf(stderr, "\n");
+            return 1;
+        }
+    }
+    return want_stats ? stats(store, columns, limit) : dump(store, columns, csv, limit);
+}
@@ -0,0 +1,198 @@
+// flow_imbalance_kernelcheck -- check that the process_batch kernels agree bit for bit with the scalar loop
+// Usage: flow_imbalance_kernelcheck
+//
+// Runs ewma_batch_scalar, ewma_batch_avx2 and ewma_batch_avx512 over fixed pseudo-random batches
+// of several shapes (odd sizes exercise the scalar leftovers of the vector kernels), with and
+// without the init / final_ewma hooks. Every classification and every final EWMA must equal the
+// scalar kernel's bit for bit. Kernels the CPU does not support are skipped with a SKIP line.
+//
+// ewma_batch_parallel runs on every checked kernel as well, on a pool of several threads:
+// - chunks of whole sequences must equal the serial ewma_batch bit for bit
+// - the two-pass time-chunked scan may only flip a sample whose serial EWMA is within the
+//   PARALLEL_SCAN_ULP_MARGIN documented in ParallelBatch.h of +/-threshold; flips that
+//   stayed within it are reported as scan_flips
+//
+// Prints one FAIL line per mismatching run and a KERNELCHECK summary; exits 1 if anything failed.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "main/pipeline/ThreadPool.h"
+#include "main/predictor/BatchKernels.h"
+#include "main/predictor/ParallelBatch.h"
+
+namespace {
+
+struct Shape {
+    size_t num_seqs;
+    size_t seq_len;
+};
+
+// 1 sequence, partial SIMD groups, one group plus leftovers, odd sizes, long and odd, long single
+const Shape SHAPES[] = {{1, 1}, {3, 7}, {5, 9}, {17, 33}, {9, 4099}, {1, 20000}, {2, 9000}};
+
+constexpr double ALPHA = 0.15;
+constexpr double THRESHOLD = 40.0;
+
+// ewma_batch_parallel gets its own pool of this many threads, whatever the machine has
+constexpr size_t POOL_THREADS = 4;
+// whole-sequence chunks: at least POOL_THREADS * 16 sequences, or sequences too short to split
+const Shape SPLIT_SHAPES[] = {{100, 300}, {40, 50}, {64, 2 * PARALLEL_SCAN_MIN_CHUNK + 1}};
+// two-pass scan: fewer sequences than that, each at least two minimum chunks long
+const Shape SCAN_SHAPES[] = {{1, 2 * PARALLEL_SCAN_MIN_CHUNK}, {2, 3 * PARALLEL_SCAN_MIN_CHUNK + 17}, {3, 40000}};
+// slow enough that the carry between time chunks matters: (1 - alpha)^4096 is about 2%
+constexpr double SCAN_ALPHA = 0.001;
+
+// a swing of +/-80 plus noise, so the EWMA crosses both thresholds many times;
+// `period` is in samples and grows a little per sequence
+std::vector<double> make_data(size_t num_seqs, size_t seq_len, uint64_t seed, double base_period = 200.0) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> noise(-100.0, 100.0);
+    std::vector<double> data(num_seqs * seq_len);
+    for (size_t s = 0; s < num_seqs; ++s) {
+        const double period = base_period * (1.0 + 0.185 * double(s));
+        for (size_t i = 0; i < seq_len; ++i) {
+            data[s * seq_len + i] = 80.0 * std::sin(6.283185307179586 * double(i) / period) + noise(rng);
+        }
+    }
+    return data;
+}
+
+using KernelFn = void (*)(const double*, size_t, size_t, double, double, int*, const double*, double*);
+
+struct Kernel {
+    BatchKernel id;
+    KernelFn fn;
+};
+
+const Kernel KERNELS[] = {
+    {BatchKernel::Scalar, ewma_batch_scalar},
+    {BatchKernel::Avx2, ewma_batch_avx2},
+    {BatchKernel::Avx512, ewma_batch_avx512},
+};
+
+uint64_t seed_of(const Shape& sh) { return sh.num_seqs * 1000003 + sh.seq_len; }
+
+// true if `k` matched the scalar reference on this shape
+bool check(const Kernel& k, const Shape& sh, bool hooks) {
+    const size_t n = sh.num_seqs * sh.seq_len;
+    const std::vector<double> data = make_data(sh.num_seqs, sh.seq_len, seed_of(sh));
+    std::vector<double> init(sh.num_seqs);
+    for (size_t s = 0; s < sh.num_seqs; ++s) init[s] = 60.0 * std::cos(double(s));
+
+    std::vector<int> want(n), got(n, 7);
+    std::vector<double> want_final(sh.num_seqs), got_final(sh.num_seqs, -1.0);
+    ewma_batch_scalar(data.data(), sh.num_seqs, sh.seq_len, ALPHA, THRESHOLD, want.data(),
+                      hooks ? init.data() : nullptr, hooks ? want_final.data() : nullptr);
+    k.fn(data.data(), sh.num_seqs, sh.seq_len, ALPHA, THRESHOLD, got.data(),
+         hooks ? init.data() : nullptr, hooks ? got_final.data() : nullptr);
+
+    for (size_t i = 0; i < n; ++i) {
+        if (got[i] == want[i]) continue;
+        std::printf("FAIL kernel=%s shape=%zux%zu hooks=%d seq=%zu sample=%zu got=%d expected=%d\n",
+                    batch_kernel_name(k.id), sh.num_seqs, sh.seq_len, int(hooks), i / sh.seq_len, i % sh.seq_len,
+                    got[i], want[i]);
+        return false;
+    }
+    if (hooks && std::memcmp(got_final.data(), want_final.data(), sh.num_seqs * sizeof(double)) != 0) {
+        for (size_t s = 0; s < sh.num_seqs; ++s) {
+            if (std::memcmp(&got_final[s], &want_final[s], sizeof(double)) == 0) continue;
+            std::printf("FAIL kernel=%s shape=%zux%zu hooks=1 seq=%zu final_ewma=%.17g expected=%.17g\n",
+                        batch_kernel_name(k.id), sh.num_seqs, sh.seq_len, s, got_final[s], want_final[s]);
+            break;
+        }
+        return false;
+    }
+    return true;
+}
+
+// whole-sequence chunks on the pool against the serial kernel; true if bit-identical
+bool check_split(ThreadPool& pool, const Kernel& k, const Shape& sh) {
+    const size_t n = sh.num_seqs * sh.seq_len;
+    const std::vector<double> data = make_data(sh.num_seqs, sh.seq_len, seed_of(sh));
+    std::vector<int> want(n), got(n, 7);
+    ewma_batch(k.id, data.data(), sh.num_seqs, sh.seq_len, ALPHA, THRESHOLD, want.data());
+    ewma_batch_parallel(pool, k.id, data.data(), sh.num_seqs, sh.seq_len, ALPHA, THRESHOLD, got.data());
+    for (size_t i = 0; i < n; ++i) {
+        if (got[i] == want[i]) continue;
+        std::printf("FAIL parallel=split kernel=%s shape=%zux%zu seq=%zu sample=%zu got=%d expected=%d\n",
+                    batch_kernel_name(k.id), sh.num_seqs, sh.seq_len, i / sh.seq_len, i % sh.seq_len, got[i], want[i]);
+        return false;
+    }
+    return true;
+}
+
+// two-pass scan on the pool against the serial recurrence; true if every flip is within the margin
+bool check_scan(ThreadPool& pool, const Kernel& k, const Shape& sh, uint64_t& flips) {
+    const size_t n = sh.num_seqs * sh.seq_len;
+    const std::vector<double> data = make_data(sh.num_seqs, sh.seq_len, seed_of(sh), 5000.0);
+    std::vector<int> want(n), got(n, 7);
+    ewma_batch(k.id, data.data(), sh.num_seqs, sh.seq_len, SCAN_ALPHA, THRESHOLD, want.data());
+    ewma_batch_parallel(pool, k.id, data.data(), sh.num_seqs, sh.seq_len, SCAN_ALPHA, THRESHOLD, got.data());
+    bool pass = true;
+    for (size_t s = 0; s < sh.num_seqs; ++s) {
+        const double* x = data.data() + s * sh.seq_len;
+        double largest = 0.0;
+        for (size_t i = 0; i < sh.seq_len; ++i) largest = std::max(largest, std::fabs(x[i]));
+        const double ulp = std::nextafter(largest, HUGE_VAL) - largest;
+        const double margin = PARALLEL_SCAN_ULP_MARGIN / SCAN_ALPHA * ulp;
+        // the serial EWMA, stepped exactly like ewma_batch_scalar
+        double e = 0.0;
+        for (size_t i = 0; i < sh.seq_len; ++i) {
+            e = SCAN_ALPHA * x[i] + (1.0 - SCAN_ALPHA) * e;
+            const size_t j = s * sh.seq_len + i;
+            if (got[j] == want[j]) continue;
+            const double distance = std::fabs(std::fabs(e) - THRESHOLD);
+            if (distance <= margin) {
+                ++flips;
+                continue;
+            }
+            std::printf("FAIL parallel=scan kernel=%s shape=%zux%zu seq=%zu sample=%zu got=%d expected=%d "
+                        "ewma=%.17g threshold_distance=%.3g margin=%.3g\n",
+                        batch_kernel_name(k.id), sh.num_seqs, sh.seq_len, s, i, got[j], want[j], e, distance, margin);
+            pass = false;
+            break;
+        }
+    }
+    return pass;
+}
+
+} // namespace
+
+int main() {
+    const BatchKernel best = detect_batch_kernel();
+    ThreadPool pool(POOL_THREADS);
+    uint64_t runs = 0, parallel_runs = 0, scan_flips = 0, failed = 0;
+    std::string checked;
+    for (const Kernel& k : KERNELS) {
+        if (int(k.id) > int(best)) {
+            std::printf("SKIP kernel=%s not supported by this CPU\n", batch_kernel_name(k.id));
+            continue;
+        }
+        checked += checked.empty() ? "" : ",";
+        checked += batch_kernel_name(k.id);
+        for (const Shape& sh : SHAPES) {
+            for (bool hooks : {false, true}) {
+                ++runs;
+                if (!check(k, sh, hooks)) ++failed;
+            }
+        }
+        for (const Shape& sh : SPLIT_SHAPES) {
+            ++parallel_runs;
+            if (!check_split(pool, k, sh)) ++failed;
+        }
+        for (const Shape& sh : SCAN_SHAPES) {
+            ++parallel_runs;
+            if (!check_scan(pool, k, sh, scan_flips)) ++failed;
+        }
+    }
+    std::printf("KERNELCHECK kernels=%s runs=%llu parallel_runs=%llu scan_flips=%llu failed=%llu\n", checked.c_str(),
+                (unsigned long long)runs, (unsigned long long)parallel_runs, (unsigned long long)scan_flips,
+                (unsigned long long)failed);
+    return failed ? 1 : 0;
+}
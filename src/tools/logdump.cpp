@@ -0,0 +1,75 @@
+// flow_imbalance_logdump -- decode a binary signal log (--signal-log=<path>) to text
+// Usage: flow_imbalance_logdump <path> [--csv]
+//   default: the same lines flow_imbalance prints for each signal
+//   --csv:   seq,symbol,action,ewma,ofi,src_ts,recv_ts,recv_to_decision_ns,bank_vote,bank_configs
+// Version 1 logs (records without the bank fields) decode with bank_configs=0.
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+#include "main/log/SignalLog.h"
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <signal-log> [--csv]\n", argv[0]);
+        return 2;
+    }
+    std::string path = argv[1];
+    bool csv = argc > 2 && std::strcmp(argv[2], "--csv") == 0;
+
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) { perror("fopen"); return 1; }
+    SignalLogHeader h;
+    if (std::fread(&h, sizeof(h), 1, f) != 1 || std::memcmp(h.magic, "FISL", 4) != 0) {
+        std::fprintf(stderr, "%s: not a signal log\n", path.c_str());
+        std::fclose(f);
+        return 1;
+    }
+    // v1 records are the first 56 bytes of a v2 Decision
+    const bool v1 = h.version == 1 && h.record_size == offsetof(Decision, bank_vote);
+    if (!v1 && (h.version != SIGNAL_LOG_VERSION || h.record_size != sizeof(Decision))) {
+        std::fprintf(stderr, "%s: unsupported version %u / record size %u\n", path.c_str(), h.version, h.record_size);
+        std::fclose(f);
+        return 1;
+    }
+
+    // optional sidecar with symbol names; ids print as #<id> without it
+    std::unordered_map<uint32_t, std::string> names;
+    if (FILE* sf = std::fopen((path + ".symbols").c_str(), "r")) {
+        unsigned id;
+        char name[256];
+        while (std::fscanf(sf, "%u %255s", &id, name) == 2) names[id] = name;
+        std::fclose(sf);
+    }
+
+    if (csv) std::printf("seq,symbol,action,ewma,ofi,src_ts,recv_ts,recv_to_decision_ns,bank_vote,bank_configs\n");
+    Decision d{};
+    char line[256];
+    uint64_t n = 0;
+    while (std::fread(&d, h.record_size, 1, f) == 1) {
+        auto it = names.find(d.symbol);
+        std::string sym;
+        if (it != names.end()) {
+            sym = it->second;
+        } else {
+            // snprintf rather than "#" + to_string: the latter trips GCC 12 -Wrestrict at -O3
+            char id[16];
+            sym.assign(id, size_t(std::snprintf(id, sizeof(id), "#%u", d.symbol)));
+        }
+        if (csv) {
+            std::printf("%llu,%s,%d,%.6f,%.6f,%.9f,%.9f,%lld,%d,%u\n", (unsigned long long)d.seq, sym.c_str(), d.action,
+                        d.ewma, d.ofi, d.src_ts, d.recv_ts, (long long)d.recv_to_decision_ns, d.bank_vote,
+                        d.bank_configs);
+        } else {
+            int len = format_decision(line, sizeof(line), d, sym);
+            std::fwrite(line, 1, size_t(len), stdout);
+        }
+        ++n;
+    }
+    std::fclose(f);
+    std::fprintf(stderr, "%llu records\n", (unsigned long long)n);
+    return 0;
+}
@@ -0,0 +1,144 @@
+// flow_imbalance_parsecheck -- run parse_tick_csv over a corpus and compare with the expected results
+// Usage: flow_imbalance_parsecheck <corpus>
+//   <corpus>  lines of `<input>\t<expected>` as written by src/gen/parser_corpus.py; the input is
+//             escaped (\\ \t \r \n \0 \xHH), expected is a ParseError name or
+//             `ok <seq> <src_ts> <price> <size> <src_ts tol> <price tol> [<symbol>]`
+//
+// Prints one FAIL line per mismatch and a PARSECHECK summary; exits 1 if anything failed.
+// Each double has its own tolerance: `exact` must compare equal, `ulp` may be one ulp off.
+// seq, size and symbol always compare equal.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#include "main/parser/TickParser.h"
+
+namespace {
+
+int hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// inverse of escape() in parser_corpus.py; false on a malformed escape
+bool unescape(std::string_view in, std::string& out) {
+    out.clear();
+    for (size_t i = 0; i < in.size(); ++i) {
+        if (in[i] != '\\') { out += in[i]; continue; }
+        if (++i == in.size()) return false;
+        switch (in[i]) {
+            case '\\': out += '\\'; break;
+            case 't': out += '\t'; break;
+            case 'r': out += '\r'; break;
+            case 'n': out += '\n'; break;
+            case '0': out += '\0'; break;
+            case 'x': {
+                if (i + 2 >= in.size()) return false;
+                int hi = hex_digit(in[i + 1]), lo = hex_digit(in[i + 2]);
+                if (hi < 0 || lo < 0) return false;
+                out += char(hi * 16 + lo);
+                i += 2;
+                break;
+            }
+            default: return false;
+        }
+    }
+    return true;
+}
+
+const char* error_name(ParseError e) {
+    switch (e) {
+        case ParseError::None: return "ok";
+        case ParseError::Empty: return "Empty";
+        case ParseError::Fields: return "Fields";
+        case ParseError::BadSeq: return "BadSeq";
+        case ParseError::BadSrcTs: return "BadSrcTs";
+        case ParseError::BadPrice: return "BadPrice";
+        case ParseError::BadSize: return "BadSize";
+        case ParseError::BadSymbol: return "BadSymbol";
+    }
+    return "?";
+}
+
+bool close_enough(double got, double want, bool exact) {
+    if (got == want) return std::signbit(got) == std::signbit(want);
+    return !exact && (got == std::nextafter(want, HUGE_VAL) || got == std::nextafter(want, -HUGE_VAL));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <corpus>\n", argv[0]);
+        return 2;
+    }
+    std::ifstream in(argv[1]);
+    if (!in) { std::perror(argv[1]); return 2; }
+
+    // exact / ulp count doubles, two per ok case
+    uint64_t cases = 0, ok = 0, errors = 0, exact = 0, ulp = 0, failed = 0;
+    std::string line, input;
+    size_t lineno = 0;
+    while (std::getline(in, line)) {
+        ++lineno;
+        size_t tab = line.find('\t');
+        if (tab == std::string::npos || !unescape(std::string_view(line).substr(0, tab), input)) {
+            std::fprintf(stderr, "%s:%zu: malformed corpus line\n", argv[1], lineno);
+            return 2;
+        }
+        std::string expected = line.substr(tab + 1);
+        ++cases;
+
+        Tick t{};
+        std::string_view symbol;
+        ParseError e = parse_tick_csv(input.data(), input.size(), t, symbol);
+
+        std::istringstream want(expected);
+        std::string kind;
+        want >> kind;
+        bool pass;
+        std::string detail;
+        if (kind != "ok") {
+            ++errors;
+            pass = e != ParseError::None && kind == error_name(e);
+            if (!pass) detail = std::string("got ") + error_name(e);
+        } else {
+            uint64_t seq = 0;
+            std::string src_ts, price, src_ts_tol, price_tol, sym;
+            uint32_t size = 0;
+            want >> seq >> src_ts >> price >> size >> src_ts_tol >> price_tol >> sym;
+            bool src_ts_exact = src_ts_tol == "exact", price_exact = price_tol == "exact";
+            ++(src_ts_exact ? exact : ulp);
+            ++(price_exact ? exact : ulp);
+            ++ok;
+            std::string want_sym;
+            unescape(sym, want_sym);
+            pass = e == ParseError::None && t.seq == seq && t.size == size &&
+                   close_enough(t.src_ts, std::strtod(src_ts.c_str(), nullptr), src_ts_exact) &&
+                   close_enough(t.price, std::strtod(price.c_str(), nullptr), price_exact) &&
+                   symbol == want_sym;
+            if (!pass) {
+                char buf[256];
+                std::snprintf(buf, sizeof(buf), "got %s %llu %.17g %.17g %u %.*s", error_name(e),
+                              (unsigned long long)t.seq, t.src_ts, t.price, t.size, int(symbol.size()), symbol.data());
+                detail = buf;
+            }
+        }
+        if (!pass) {
+            ++failed;
+            std::printf("FAIL line=%zu input=%s expected=\"%s\" %s\n", lineno, line.substr(0, tab).c_str(),
+                        expected.c_str(), detail.c_str());
+        }
+    }
+    std::printf("PARSECHECK cases=%llu ok=%llu errors=%llu exact=%llu ulp=%llu failed=%llu\n",
+                (unsigned long long)cases, (unsigned long long)ok, (unsigned long long)errors,
+                (unsigned long long)exact, (unsigned long long)ulp, (unsigned long long)failed);
+    return failed ? 1 : 0;
+}
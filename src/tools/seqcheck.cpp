@@ -0,0 +1,149 @@
+// flow_imbalance_seqcheck -- drive the feed Sequencer through fixed scenarios and check what it releases
+// Usage: flow_imbalance_seqcheck
+//
+// Each scenario is a list of push / poll / flush steps against a fresh Sequencer. The released
+// seqs, with `G` for every gap callback, must match the expected string, and every counter
+// must match exactly. Prints one FAIL line per mismatch and a SEQCHECK summary; exits 1 if
+// anything failed.
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "main/ingest/Sequencer.h"
+
+namespace {
+
+struct Step {
+    enum Op { Push, Poll, Flush } op;
+    uint64_t seq;        // Push only
+    double src_ts;       // Push only
+    double now;          // Push and Poll
+    const char* output;  // released so far after this step, nullptr = not checked
+};
+
+struct Scenario {
+    const char* name;
+    size_t window;
+    double timeout_s;
+    std::vector<Step> steps;
+    const char* output;
+    SequencerCounters counters;
+};
+
+Step push(uint64_t seq, double now, double src_ts = 0.0, const char* output = nullptr) {
+    return {Step::Push, seq, src_ts, now, output};
+}
+Step poll(double now, const char* output = nullptr) { return {Step::Poll, 0, 0.0, now, output}; }
+Step flush(const char* output = nullptr) { return {Step::Flush, 0, 0.0, 0.0, output}; }
+
+// window 8 and a 10 ms timeout everywhere; `now` is in seconds
+const std::vector<Scenario>& scenarios() {
+    static const std::vector<Scenario> all = {
+        {"in_order", 8, 0.01,
+         {push(0, 0.000), push(1, 0.001), push(2, 0.002), push(3, 0.003), push(4, 0.004)},
+         "0 1 2 3 4", {.in_order = 5}},
+        {"reorder", 8, 0.01,
+         {push(0, 0.000), push(2, 0.001, 0.0, "0"), push(3, 0.002, 0.0, "0"), push(1, 0.003, 0.0, "0 1 2 3"),
+          push(4, 0.004)},
+         "0 1 2 3 4", {.in_order = 3, .reordered = 2, .max_held = 2}},
+        // a delivered seq again, and a held seq again
+        {"duplicate", 8, 0.01,
+         {push(0, 0.000), push(1, 0.001), push(1, 0.002), push(3, 0.003), push(3, 0.004), push(2, 0.005)},
+         "0 1 2 3", {.in_order = 3, .reordered = 1, .duplicates = 2, .max_held = 1}},
+        // poll gives the gap up only once it is timeout old; seq 1 then arrives late
+        {"timeout_poll", 8, 0.01,
+         {push(0, 0.000), push(2, 0.001), poll(0.005, "0"), poll(0.020, "0 G 2"), push(1, 0.030, 0.0, "0 G 2"),
+          push(3, 0.031)},
+         "0 G 2 3", {.in_order = 2, .reordered = 1, .late = 1, .gaps = 1, .dropped = 1, .max_held = 1}},
+        // the next push after the timeout gives the gap up before it is sequenced itself
+        {"timeout_push", 8, 0.01,
+         {push(0, 0.000), push(2, 0.001), push(5, 0.050, 0.0, "0 G 2"), push(3, 0.051), push(4, 0.052)},
+         "0 G 2 3 4 5", {.in_order = 3, .reordered = 2, .gaps = 1, .dropped = 1, .max_held = 1}},
+        // 12 is a window past next: 1-2 and 4 are given up at once, 5-11 at the flush
+        {"overflow", 8, 0.01,
+         {push(0, 0.000), push(3, 0.001), push(12, 0.002, 0.0, "0 G 3 G"), flush()},
+         "0 G 3 G G 12", {.in_order = 1, .reordered = 2, .gaps = 3, .dropped = 10, .max_held = 1}},
+        // more than two windows ahead: the whole run before the new window goes in one gap
+        {"overflow_far", 8, 0.01,
+         {push(0, 0.000), push(100, 0.001, 0.0, "0 G"), push(99, 0.002, 0.0, "0 G"), flush()},
+         "0 G G 99 100", {.in_order = 1, .reordered = 2, .gaps = 2, .dropped = 98, .max_held = 2}},
+        // far behind with a newer src_ts restarts the sequence; far behind and older is late
+        {"restart", 8, 0.01,
+         {push(100, 0.000, 1.0), push(101, 0.001, 1.1), push(102, 0.002, 1.2), push(50, 0.003, 1.3),
+          push(51, 0.004, 1.4), push(5, 0.005, 0.5)},
+         "100 101 102 G 50 51", {.in_order = 5, .late = 1, .resets = 1}},
+        // end of stream: held ticks are released in order, missing seqs become gaps
+        {"flush", 8, 0.01,
+         {push(0, 0.000), push(2, 0.001), push(4, 0.002), push(6, 0.003, 0.0, "0"), flush()},
+         "0 G 2 G 4 G 6", {.in_order = 1, .reordered = 3, .gaps = 3, .dropped = 3, .max_held = 3}},
+    };
+    return all;
+}
+
+void append(std::string& out, const std::string& item) {
+    if (!out.empty()) out += ' ';
+    out += item;
+}
+
+bool check_counter(const char* scenario, const char* name, uint64_t got, uint64_t want) {
+    if (got == want) return true;
+    std::printf("FAIL scenario=%s counter=%s got=%llu expected=%llu\n", scenario, name, (unsigned long long)got,
+                (unsigned long long)want);
+    return false;
+}
+
+// true if the scenario passed
+bool run(const Scenario& sc) {
+    Sequencer seq(sc.window, sc.timeout_s);
+    std::string out;
+    auto emit = [&](const Tick& t) { append(out, std::to_string(t.seq)); };
+    auto gap = [&] { append(out, "G"); };
+    bool pass = true;
+    for (size_t i = 0; i < sc.steps.size(); ++i) {
+        const Step& st = sc.steps[i];
+        if (st.op == Step::Push) {
+            Tick t{};
+            t.seq = st.seq;
+            t.src_ts = st.src_ts;
+            seq.push(t, st.now, emit, gap);
+        } else if (st.op == Step::Poll) {
+            seq.poll(st.now, emit, gap);
+        } else {
+            seq.flush(emit, gap);
+        }
+        if (st.output && out != st.output) {
+            std::printf("FAIL scenario=%s step=%zu released=\"%s\" expected=\"%s\"\n", sc.name, i, out.c_str(), st.output);
+            pass = false;
+        }
+    }
+    if (out != sc.output) {
+        std::printf("FAIL scenario=%s released=\"%s\" expected=\"%s\"\n", sc.name, out.c_str(), sc.output);
+        pass = false;
+    }
+    const SequencerCounters& c = seq.counters();
+    const SequencerCounters& w = sc.counters;
+    pass &= check_counter(sc.name, "in_order", c.in_order, w.in_order);
+    pass &= check_counter(sc.name, "reordered", c.reordered, w.reordered);
+    pass &= check_counter(sc.name, "duplicates", c.duplicates, w.duplicates);
+    pass &= check_counter(sc.name, "late", c.late, w.late);
+    pass &= check_counter(sc.name, "gaps", c.gaps, w.gaps);
+    pass &= check_counter(sc.name, "dropped", c.dropped, w.dropped);
+    pass &= check_counter(sc.name, "resets", c.resets, w.resets);
+    pass &= check_counter(sc.name, "max_held", c.max_held, w.max_held);
+    // every scenario ends with nothing held: the last step flushes or closes all gaps
+    pass &= check_counter(sc.name, "held", seq.held(), 0);
+    return pass;
+}
+
+} // namespace
+
+int main() {
+    uint64_t scenarios_run = 0, failed = 0;
+    for (const Scenario& sc : scenarios()) {
+        ++scenarios_run;
+        if (!run(sc)) ++failed;
+    }
+    std::printf("SEQCHECK scenarios=%llu failed=%llu\n", (unsigned long long)scenarios_run, (unsigned long long)failed);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,160 @@
+// flow_imbalance_stat -- show the live metrics of a flow_imbalance run started with --metrics
+// Usage: flow_imbalance_stat [--name=<shm name>] [--watch=<sec>] [--json]
+//   --name=<n>     segment to attach (default /flow_imbalance, as --metrics without a name)
+//   --watch=<sec>  sample every <sec> seconds until the engine exits or Ctrl+C, adding
+//                  per-second rates since the previous sample
+//   --json         one JSON object per slot per sample instead of key=value lines
+//
+// Attaches read-only: it never writes to the segment and cannot slow the engine down.
+
+#include <signal.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "main/metrics/SharedMetrics.h"
+
+static std::atomic<bool> keep_running{true};
+static void sigint_handler(int) { keep_running = false; }
+
+namespace {
+
+struct Counters {
+    uint64_t datagrams, parse_errors, kernel_drops, tick_ring_drops, tick_ring_depth;
+    uint64_t ticks, buy, sell, seq_dropped, seq_held, log_drops, log_ring_depth;
+};
+
+Counters load(const MetricsSlot& s) {
+    auto r = [](const MetricCounter& c) { return c.load(std::memory_order_relaxed); };
+    return Counters{r(s.datagrams), r(s.parse_errors), r(s.kernel_drops), r(s.tick_ring_drops), r(s.tick_ring_depth),
+                    r(s.ticks),     r(s.buy),          r(s.sell),         r(s.seq_dropped),     r(s.seq_held),
+                    r(s.log_drops), r(s.log_ring_depth)};
+}
+
+double wall_now() {
+    return std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// label copied out of shared memory, always terminated
+std::string label_of(const MetricsSlot& s) { return std::string(s.label, strnlen(s.label, sizeof(s.label))); }
+
+void print_latency(bool json, const char* name, const MetricsPercentiles& p) {
+    if (json) {
+        std::printf(",\"%s\":{\"count\":%llu,\"p50\":%.2f,\"p90\":%.2f,\"p99\":%.2f,\"p99.9\":%.2f,\"max\":%.2f}", name,
+                    (unsigned long long)p.count, p.p50 / 1e3, p.p90 / 1e3, p.p99 / 1e3, p.p999 / 1e3, p.max / 1e3);
+    } else {
+        std::printf(" %s count=%llu p50=%.2f p90=%.2f p99=%.2f p99.9=%.2f max=%.2f", name, (unsigned long long)p.count,
+                    p.p50 / 1e3, p.p90 / 1e3, p.p99 / 1e3, p.p999 / 1e3, p.max / 1e3);
+    }
+}
+
+// one sample of slot i; `prev` / `dt` give rates when dt > 0
+void print_slot(const MetricsReader& r, size_t i, const Counters& c, const Counters& prev, double dt, bool json) {
+    const MetricsHeader& h = r.header();
+    const MetricsSlot& s = r.slot(i);
+    const double now = wall_now();
+    const char* state = h.state.load(std::memory_order_acquire) == METRICS_EXITED ? "exited" : "running";
+    const std::string label = label_of(s);
+
+    struct Field { const char* name; uint64_t v; };
+    const Field fields[] = {{"datagrams", c.datagrams},       {"ticks", c.ticks},
+                            {"buy", c.buy},                   {"sell", c.sell},
+                            {"parse_errors", c.parse_errors}, {"kernel_drops", c.kernel_drops},
+                            {"tick_ring_drops", c.tick_ring_drops}, {"tick_ring_depth", c.tick_ring_depth},
+                            {"seq_dropped", c.seq_dropped},   {"seq_held", c.seq_held},
+                            {"log_drops", c.log_drops},       {"log_ring_depth", c.log_ring_depth}};
+    if (json) {
+        std::printf("{\"ts\":%.3f,\"slot\":%zu,\"label\":\"%s\",\"pid\":%d,\"state\":\"%s\",\"uptime_s\":%.1f", now, i,
+                    label.c_str(), h.pid, state, now - h.start_ts);
+        for (const Field& f : fields) std::printf(",\"%s\":%llu", f.name, (unsigned long long)f.v);
+    } else {
+        std::printf("METRICS slot=%zu label=%s pid=%d state=%s uptime_s=%.1f", i, label.c_str(), h.pid, state,
+                    now - h.start_ts);
+        for (const Field& f : fields) std::printf(" %s=%llu", f.name, (unsigned long long)f.v);
+    }
+    if (dt > 0.0) {
+        const double dps = double(c.datagrams - prev.datagrams) / dt;
+        const double tps = double(c.ticks - prev.ticks) / dt;
+        if (json) std::printf(",\"datagrams_per_s\":%.0f,\"ticks_per_s\":%.0f", dps, tps);
+        else std::printf(" datagrams_per_s=%.0f ticks_per_s=%.0f", dps, tps);
+    }
+
+    MetricsTick t;
+    if (s.last_tick.version() > 0 && s.last_tick.read(t)) {
+        // age against the tick's receive time: how long the engine has been idle
+        if (json) {
+            std::printf(",\"last\":{\"seq\":%llu,\"symbol\":%u,\"action\":%d,\"ewma\":%.6f,\"ofi\":%.6f,\"age_ms\":%.3f",
+                        (unsigned long long)t.seq, t.symbol, t.action, t.ewma, t.ofi, (now - t.recv_ts) * 1e3);
+            if (t.bank_configs > 0) std::printf(",\"bank_vote\":%d,\"bank_configs\":%u", t.bank_vote, t.bank_configs);
+            std::printf("}");
+        } else {
+            std::printf(" last_seq=%llu last_symbol=#%u last_action=%d ewma=%.6f ofi=%.6f last_age_ms=%.3f",
+                        (unsigned long long)t.seq, t.symbol, t.action, t.ewma, t.ofi, (now - t.recv_ts) * 1e3);
+            if (t.bank_configs > 0) std::printf(" last_bank=%+d/%u", t.bank_vote, t.bank_configs);
+        }
+    }
+    MetricsLatency lat;
+    if (s.latency.version() > 0 && s.latency.read(lat)) {
+        print_latency(json, json ? "recv_decision_us" : "recv->decision_us", lat.recv_decision);
+        print_latency(json, json ? "src_recv_us" : "src->recv_us", lat.src_recv);
+        if (json) std::printf(",\"latency_age_ms\":%.1f", (now - lat.updated_ts) * 1e3);
+        else std::printf(" latency_age_ms=%.1f", (now - lat.updated_ts) * 1e3);
+    }
+    std::printf(json ? "}\n" : "\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string name = METRICS_DEFAULT_NAME;
+    double watch = 0.0;
+    bool json = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string a(argv[i]);
+        if (a.rfind("--name=", 0) == 0) {
+            name = metrics_shm_name(a.substr(7));
+        } else if (a.rfind("--watch=", 0) == 0) {
+            watch = std::atof(a.substr(8).c_str());
+        } else if (a == "--json") {
+            json = true;
+        } else {
+            std::fprintf(stderr, "usage: %s [--name=<shm name>] [--watch=<sec>] [--json]\n", argv[0]);
+            return 2;
+        }
+    }
+    signal(SIGINT, sigint_handler);
+
+    MetricsReader reader;
+    std::string err;
+    if (!reader.attach(name, err)) {
+        std::fprintf(stderr, "%s (is flow_imbalance running with --metrics?)\n", err.c_str());
+        return 1;
+    }
+    const size_t n = reader.slots();
+    std::vector<Counters> prev(n);
+    for (size_t i = 0; i < n; ++i) prev[i] = load(reader.slot(i));
+    double prev_ts = wall_now();
+    double dt = 0.0;
+    for (;;) {
+        for (size_t i = 0; i < n; ++i) {
+            const Counters c = load(reader.slot(i));
+            print_slot(reader, i, c, prev[i], dt, json);
+            prev[i] = c;
+        }
+        std::fflush(stdout);
+        if (watch <= 0.0 || !keep_running) break;
+        // the writer unlinks on exit; the last sample above already shows its final values
+        if (reader.header().state.load(std::memory_order_acquire) == METRICS_EXITED) break;
+        std::this_thread::sleep_for(std::chrono::duration<double>(watch));
+        const double ts = wall_now();
+        dt = ts - prev_ts;
+        prev_ts = ts;
+    }
+    return 0;
+}